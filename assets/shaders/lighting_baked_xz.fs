@@ -9,7 +9,18 @@ out vec4 finalColor;
 uniform sampler2D texture0;        // floor albedo
 uniform vec4      colDiffuse;      // set to WHITE for floors
 
-uniform sampler2D dynamicGridTex;  // the single XZ lightmap (RGB = lights, A = lava mask)
+uniform sampler2D dynamicGridTex;  // overview lightmap, one texel per tile (RGB = linear light, can go past 1.0; A = lava mask)
+
+// Full-res static light comes in pages around the player, same texel layout as the overview.
+uniform sampler2D lightPageAtlas;  // resident pages, each with a 1 texel gutter
+uniform sampler2D lightPageTable;  // R = atlas slot of the page, -1 when not resident
+uniform vec4  pageInfo;            // pageWorldSize, pageTexels, slotTexels, unused
+uniform ivec4 pageGrid;            // pagesX, pagesZ, slotsPerRow, atlasTexels
+
+// Dynamic lights (player, fireballs) as a tiled light list, see lightClusters.h for the layout.
+uniform sampler2D lightClusterTex; // RGBA32F, read with texelFetch only
+uniform ivec4 clusterInfo;         // cellsX, cellsZ, dataWidth, unused
+uniform vec4  clusterBounds;       // minX, minZ, 1/cellSizeX, 1/cellSizeZ
 
 // gridBounds = { minX, minZ, invSizeX, invSizeZ }
 uniform vec4  gridBounds;
@@ -25,6 +36,53 @@ uniform float ceilHeight;      // world-space Y where ceilings live (for attenua
 uniform float lavaFalloff;     // how fast lava glow fades with height
                                // (e.g., 200.0 means at 200 units above floor, glow ≈0)
 
+// Lightmap is HDR now, this is the one place it gets squeezed into 0..1.
+// Linear below the knee (same look as the old clamp), soft roll-off above so overlapping lights don't flatten out.
+const float kToneKnee = 0.8;
+vec3 ToneMapLight(vec3 L) {
+    vec3 over = max(L - vec3(kToneKnee), vec3(0.0));
+    vec3 rolled = kToneKnee + (1.0 - kToneKnee) * (vec3(1.0) - exp(-over / (1.0 - kToneKnee)));
+    return mix(max(L, vec3(0.0)), rolled, step(vec3(kToneKnee), L));
+}
+
+// Resident page if there is one, overview otherwise.
+vec4 SampleStaticLight(vec2 xz, vec2 lmUV) {
+    vec2 rel = xz - gridBounds.xy;
+    ivec2 page = ivec2(floor(rel / pageInfo.x));
+    if (page.x >= 0 && page.y >= 0 && page.x < pageGrid.x && page.y < pageGrid.y) {
+        float slot = texelFetch(lightPageTable, page, 0).r;
+        if (slot >= 0.0) {
+            int s = int(slot);
+            vec2 origin = vec2(s % pageGrid.z, s / pageGrid.z) * pageInfo.z + 1.0; // past the gutter
+            vec2 local  = (rel - vec2(page) * pageInfo.x) / pageInfo.x * pageInfo.y;
+            return texture(lightPageAtlas, (origin + local) / float(pageGrid.w));
+        }
+    }
+    return texture(dynamicGridTex, lmUV);
+}
+
+// Sum of the lights listed for this fragment's cell. Falloff over the full 3D distance so walls fade with
+// height, same curve as SmoothFalloff on the CPU: smoothstep of 1 - d/r, not the bake's 1 - d^2/r^2.
+vec3 ClusterLights(vec3 p) {
+    ivec2 cell = ivec2(floor((p.xz - clusterBounds.xy) * clusterBounds.zw));
+    if (cell.x < 0 || cell.y < 0 || cell.x >= clusterInfo.x || cell.y >= clusterInfo.y) return vec3(0.0);
+
+    vec4 head = texelFetch(lightClusterTex, ivec2(cell.x * 4, cell.y), 0);
+    int count = int(head.x);
+    vec3 sum = vec3(0.0);
+    for (int k = 1; k <= count; ++k) {
+        float idxF = (k < 4) ? head[k] : texelFetch(lightClusterTex, ivec2(cell.x * 4 + k / 4, cell.y), 0)[k & 3];
+        int t = int(idxF) * 2; // two texels per light record
+        ivec2 at = ivec2(t % clusterInfo.z, clusterInfo.y + t / clusterInfo.z);
+        vec4 posRange = texelFetch(lightClusterTex, at, 0);
+        vec3 color    = texelFetch(lightClusterTex, at + ivec2(1, 0), 0).rgb;
+
+        float s = clamp(1.0 - length(p - posRange.xyz) / posRange.w, 0.0, 1.0);
+        sum += color * (s * s * (3.0 - 2.0 * s));
+    }
+    return sum;
+}
+
 void main() {
     // Albedo (ignore vColor tint for floors if colDiffuse = WHITE)
     vec4 baseS = texture(texture0, vUV);
@@ -37,13 +95,13 @@ void main() {
     vec2  lmUV = clamp(vec2(u, v), vec2(0.0), vec2(1.0));
     //vec2 lmUV = clamp(vec2(u, 1.0 - v), vec2(0.0), vec2(1.0));
 
-    // Sample lightmap once: RGB = dynamic light, A = lava mask
-    vec4 lm = texture(dynamicGridTex, lmUV);
-    vec3 dyn = lm.rgb;
+    // Sample lightmap once: RGB = static light, A = lava mask
+    vec4 lm = SampleStaticLight(vWorldPos.xz, lmUV);
+    vec3 dyn = lm.rgb + ClusterLights(vWorldPos);
     float lavaMask = lm.a; // 0..1
 
-    // Base lighting (same as before)
-    vec3 L = clamp(dyn * dynStrength + vec3(ambientBoost), 0.0, 1.0);
+    // Base lighting (same as before, tone-mapped at the end instead of clamped)
+    vec3 L = dyn * dynStrength + vec3(ambientBoost);
 
     // If drawing ceilings, add lava glow based on alpha mask
     if (isCeiling == 1) {
@@ -53,9 +111,11 @@ void main() {
 
         // Add emissive red/orange glow
         vec3 lavaGlow = vec3(1.0, 0.25, 0.0) * lavaMask * lavaCeilStrength * atten;
-        L = clamp(L + lavaGlow, 0.0, 1.0);
+        L += lavaGlow;
     }
 
+    L = ToneMapLight(L);
+
     // Shade final
     finalColor = vec4(base * L, alpha);
 }
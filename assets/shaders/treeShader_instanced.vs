@@ -0,0 +1,20 @@
+#version 330
+
+// Instanced twin of treeShader.vs for DrawMeshInstanced, same outputs so it pairs with treeShader.fs
+layout(location = 0) in vec3 vertexPosition;
+layout(location = 1) in vec2 vertexTexCoord;  // raylib default
+
+// Per-instance model matrix (shader.locs[SHADER_LOC_MATRIX_MODEL] points at it)
+in mat4 instanceTransform;
+
+uniform mat4 mvp; // view * projection here, the model part comes per instance
+
+out vec2 fragUV;
+out vec3 fragPosition;
+
+void main() {
+    vec4 worldPos   = instanceTransform * vec4(vertexPosition, 1.0);
+    fragPosition    = worldPos.xyz;
+    fragUV          = vertexTexCoord;
+    gl_Position     = mvp * worldPos;
+}
@@ -64,6 +64,7 @@ public:
     bool hasFired = false;
     bool animationLoop;
     bool canSee;
+    bool losToPlayer = false;          // filled by UpdateEnemyVisibility before the AI runs
     float deathTimer = 0.0f;
     float attackCooldown = 0.0f;
     float chaseDuration = 0.0f;
@@ -114,7 +115,8 @@ public:
     void UpdateAI(float deltaTime, Player& player); 
     void UpdateSkeletonAI(float deltaTime, Player& player);
     void UpdatePirateAI(float deltaTime, Player& player);
-    void UpdatePlayerVisibility(const Vector3& playerPos, float dt, float epsilon);
+    void ComputePlayerLOS(const Vector3& playerPos, bool playerInWater);
+    void UpdatePlayerVisibility(const Vector3& playerPos, float dt);
     bool FindRepositionTarget(const Player& player, Vector3& outTarget);
     void AlertNearbySkeletons(Vector3 alertOrigin, float radius);
     void UpdateRaptorVisibility(const Player& player, float dt);
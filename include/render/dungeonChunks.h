@@ -0,0 +1,30 @@
+#pragma once
+#include "raylib.h"
+
+// Dungeon geometry that never moves (floor, walls, lava skirts, ceiling), merged at level load into one
+// static mesh per kChunkTiles x kChunkTiles image tiles and layer. Vertices are pre-transformed to world
+// space, so a chunk layer goes out as one render queue item per model mesh with an identity transform,
+// and culls as a whole against its bounds.
+
+static const int kChunkTiles = 16;
+
+enum DungeonChunkLayer {
+    CHUNK_FLOOR,
+    CHUNK_WALLS,   // wall segments and lava skirts
+    CHUNK_CEILING,
+    CHUNK_LAYER_COUNT
+};
+
+// Queue one copy of model at the same transform DrawModelEx would use. tileX/tileY are image tile coords
+// and only pick the chunk. Every piece of a layer must use the same model.
+void AddDungeonChunkPiece(DungeonChunkLayer layer, int tileX, int tileY, const Model& model,
+                          Vector3 position, Vector3 rotationAxis, float rotationAngle, Vector3 scale);
+void ClearDungeonChunkLayer(DungeonChunkLayer layer);
+
+// Merge the queued pieces on the job pool, then upload on the calling (main) thread.
+void BuildDungeonChunks(int tilesW, int tilesH);
+void UnloadDungeonChunks(); // meshes and queued pieces
+
+// Tests each chunk against the view frustum, then PVSInView and RoomsInView over its footprint, and pushes
+// the survivors onto the render queue. Tint multiplies the model's diffuse color, like DrawModelEx.
+void DrawDungeonChunks(DungeonChunkLayer layer, Color tint);
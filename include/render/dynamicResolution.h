@@ -0,0 +1,12 @@
+#pragma once
+
+// Dynamic resolution for the 3D scene. sceneTexture and postProcessTexture are sized at GetRenderScale() times
+// the window, the bloom pass upscales to the backbuffer and the HUD draws on top at native resolution.
+// The scale steps down when frames run over the 60 fps budget and creeps back up once they have headroom.
+
+static const float kMinRenderScale = 0.5f;
+static const float kMaxRenderScale = 1.0f;
+
+// Once per rendered frame, with that frame's GetFrameTime().
+void UpdateDynamicResolution(float frameTime);
+float GetRenderScale();
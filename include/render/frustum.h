@@ -0,0 +1,25 @@
+#pragma once
+#include "raylib.h"
+
+// View-frustum culling. CameraSystem::BeginCustom3D extracts the planes of the camera it sets up, world
+// draws and the billboard gather test their bounds against that before submitting anything.
+
+// Six normalized planes (a,b,c,d), a point is inside when a*x + b*y + c*z + d >= 0.
+// Order: left, right, bottom, top, near, far.
+struct Frustum {
+    Vector4 planes[6];
+};
+
+Frustum FrustumFromMatrices(Matrix view, Matrix projection);
+bool FrustumHasSphere(const Frustum& frustum, Vector3 center, float radius);
+bool FrustumHasBox(const Frustum& frustum, const BoundingBox& box);
+
+// The frustum of the last BeginCustom3D. Everything passes until one has been set.
+void SetViewFrustum(const Frustum& frustum);
+const Frustum& GetViewFrustum();
+bool SphereInView(Vector3 center, float radius);
+bool BoxInView(const BoundingBox& box);
+
+// Radius around the model origin that holds the whole model at scale 1, under any rotation.
+// Cached per mesh array, so only call it on models that stay loaded.
+float ModelCullRadius(const Model& model);
@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+#include "raylib.h"
+#include "world/dungeonGeneration.h"
+
+// Tiled light list for dynamic lights (player light, fireballs, iceballs). The dungeon is cut into
+// XZ cells, each cell keeps the indices of the lights that reach it, and lighting_baked_xz.fs only
+// evaluates those per fragment. Cells are binned by the light's XZ circle, which holds its 3D sphere, and the
+// falloff is over the 3D distance so walls darken with height. The curve is SmoothFalloff's (smoothstep of
+// 1 - d/r), the one the dynamic lights always had. The static bake uses 1 - d^2/r^2 instead, which stays
+// brighter further out.
+//
+// Everything lives in one RGBA32F data texture, kClusterDataWidth texels wide:
+//   rows [0, cellsZ)   one cell per 4 texels: slot 0 = light count, slots 1..15 = light indices
+//   rows [cellsZ, ...) two texels per light: (pos.xyz, range), (rgb * intensity, 0)
+
+static const int kClusterDataWidth = 256;
+static const int kMaxClusterLights = 256;   // per frame, the rest are dropped
+static const int kMaxLightsPerCell = 15;
+
+void InitLightClusters(float minX, float minZ, float sizeX, float sizeZ);
+void UnloadLightClusters();
+
+// Rebuild the cell lists and upload. Lights past kMaxClusterLights, or past a full cell, are skipped.
+void BuildLightClusters(const std::vector<LightSample>& lights);
+
+// Binds the data texture and the cell mapping on the lighting shader. Call after InitLightClusters.
+void SetLightClusterShaderValues(Shader shader);
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "raylib.h"
+
+// Planar 16-bit light accumulator for the static bake. Stamps add up without clamping at 255,
+// the one 8-bit clamp happens when the bake resolves it into Colors.
+struct LightAccum16 {
+    int w = 0, h = 0;
+    std::vector<uint16_t> r, g, b;
+
+    void Reset(int width, int height);
+};
+
+// Stamps one row of texels. Texel i sits at world x = wx0 + i * wxStep, dz2 is the row's squared
+// z distance to the light. Adds (int)(color * smoothstep(1 - d2/r2) * vis[i]) per channel, saturating.
+// AVX2/SSE2 when the compiler has them, scalar otherwise, same math in all three.
+void StampLightRow(uint16_t* r, uint16_t* g, uint16_t* b, int count,
+                   float wx0, float wxStep, float lightX, float dz2, float r2,
+                   const float* vis, Color color);
+
+// IEEE half from float, round to nearest. Light values are small and non-negative, anything below the
+// smallest normal half flushes to 0.
+uint16_t FloatToHalf(float f);
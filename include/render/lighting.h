@@ -11,7 +11,7 @@ struct BakedLightmap {
     int w = 0, h = 0;
     // World-space mapping (XZ -> [0..1])
     float minX = 0, minZ = 0, sizeX = 1, sizeZ = 1; // size = max - min
-    std::vector<Color> pixels; // CPU buffer (RGB in 0..255)
+    std::vector<Color> pixels; // CPU buffer (RGB in 0..255). Empty for gDynamic, its overview is half-float inside lighting.cpp
 };
 
 extern BakedLightmap gDynamic;  //is it really a bakedLighmap if it's dynamic? it's a hybrid
@@ -19,8 +19,19 @@ extern BakedLightmap gLavaGlow;  // lava glow map
 
 float SmoothFalloff(float d, float radius);
 
-void InitDynamicLightmap(int res);
+// Static lightmap is paged, texelsPerTile sets the page density. gDynamic holds the one-texel-per-tile
+// overview the shader falls back to where no page is resident.
+void InitDynamicLightmap(int texelsPerTile);
 void BuildStaticLightmapOnce(const std::vector<LightSource>& dungeonLights);
-void BuildDynamicLightmapFromFrameLights(const std::vector<LightSample>& frameLights);
+// Per frame: bakes or loads a few missing pages around center, nearest first.
+void UpdateLightmapPages(const Vector3& center);
+void SetLightmapPageShaderValues(Shader shader);
+
+// A door opened/closed or a barrel broke inside changed. Rebakes the lights that reach it in the
+// background, the new light shows up all at once a few frames later.
+void RebakeLightsAround(const BoundingBox& changed);
+void CancelLightRebake(); // before anything the bake reads goes away
+// Player light + this frame's movers into the light cluster list. The lightmap itself stays static.
+void UploadFrameLights(const std::vector<LightSample>& frameLights);
 
 void LogDynamicLightmapNonBlack(const char* tag);
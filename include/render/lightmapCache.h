@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// On-disk cache for baked lightmaps, one DEFLATE-compressed file per key under cache/lightmaps.
+// The key is whatever the caller hashes together (map pixels, light list, bake settings).
+
+// FNV-1a, chain calls by passing the previous result as seed.
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+
+// Creates the cache directory if it's missing. Main thread, before any job that saves.
+bool EnsureLightmapCacheDir();
+
+// Deletes the least recently used files until the cache is under its size cap. Rebakes after door and
+// barrel changes key new files, this keeps them from piling up. Main thread, while no job touches the cache.
+void TrimLightmapCache();
+
+// Texels are RGBA half floats, 4 uint16 each. Load and save are safe to call from job pool workers.
+// false on miss, wrong size or a damaged file; out is left alone then.
+bool LoadLightmapCache(uint64_t key, int w, int h, std::vector<uint16_t>& out);
+// Does nothing useful until EnsureLightmapCacheDir has run.
+void SaveLightmapCache(uint64_t key, int w, int h, const std::vector<uint16_t>& rgbaHalf);
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include "raylib.h"
+
+// Render queue for opaque mesh draws. Draw* functions push meshes instead of drawing them, RenderFrame
+// flushes once: items are sorted on a 64-bit key (pass, shader, material, depth) and executed with the
+// shader, textures and tint only rebound when they change between neighbouring items. Per item it does
+// what DrawMesh does, so anything that works through DrawModelEx works through the queue.
+//
+// Key layout, high to low: pass (2) | shader id (12) | material (16) | front-to-back depth (24) | spare (10)
+
+enum RenderPass : uint8_t {
+    RENDER_PASS_OPAQUE,
+    RENDER_PASS_COUNT
+};
+
+// sortCenter is only used for the depth bits, transform is applied like DrawMesh's.
+void RenderQueuePush(const Mesh& mesh, const Material& material, const Matrix& transform, Color tint,
+                     Vector3 sortCenter, RenderPass pass = RENDER_PASS_OPAQUE);
+
+// Every mesh of the model, with the same transform and tint rules as DrawModelEx.
+void RenderQueuePushModel(const Model& model, Vector3 position, Vector3 rotationAxis, float rotationAngle,
+                          Vector3 scale, Color tint);
+
+// Sort and draw everything pushed since the last flush, then clear. Needs the 3D camera matrices
+// (inside BeginMode3D/BeginCustom3D); cameraPos orders the depth bits front to back.
+void RenderQueueFlush(Vector3 cameraPos);
@@ -0,0 +1,17 @@
+#pragma once
+#include "raylib.h"
+
+// Billboard sprite sheets (enemies, fire, decals, muzzle flash, pickups, webs) packed into 4096x4096
+// atlas pages at load, so a frame's sorted billboards share one texture and rlgl keeps them in one draw.
+// The sheets stay loaded on their own too, anything not going through the billboard path keeps using them.
+
+struct AtlasRegion {
+    unsigned int textureId; // atlas page, or the texture itself when it wasn't packed
+    Rectangle uv;           // normalized rect of the texture inside that page, {0,0,1,1} when not packed
+};
+
+// After the sprite textures are loaded, reads the same files again to pack them.
+void BuildSpriteAtlas();
+void UnloadSpriteAtlas();
+
+AtlasRegion GetAtlasRegion(const Texture2D& texture);
@@ -0,0 +1,20 @@
+#pragma once
+#include "raylib.h"
+
+// Overworld terrain as a grid of heightmap chunks with geomipmapped LODs, in place of one
+// GenMeshHeightmap over the whole image. Each chunk covers kTerrainChunkQuads x kTerrainChunkQuads
+// heightmap cells; LOD n keeps every 2^n-th sample. Chunks pick their LOD by camera distance and hang a
+// skirt off every edge so the cracks between neighbours at different LODs stay closed.
+// Vertices are in world space, laid out exactly like the old model drawn at (-scale.x/2, 0, -scale.z/2).
+
+static const int kTerrainChunkQuads = 64;
+static const int kTerrainLodCount = 5;    // 64, 32, 16, 8, 4 quads per side
+static const int kTerrainResidentLod = 2; // this LOD and coarser are built at load, finer ones on demand
+
+// The heightmap must stay loaded (grayscale) until UnloadTerrainChunks, fine LODs are built from it lazily.
+void BuildTerrainChunks(const Image& heightmap, Vector3 terrainScale);
+void UnloadTerrainChunks();
+
+// Frustum culls, picks a LOD per chunk and pushes it onto the render queue. Builds a few missing fine LODs
+// per frame (coarser stand in until then) and drops fine LODs that haven't been drawn for a while.
+void DrawTerrainChunks(const Material& material, Vector3 cameraPos);
@@ -1,10 +1,11 @@
 #pragma once
 #include "raylib.h"
+#include <cstdint>
 #include <vector>
 #include "util/decal.h"
 #include "tools/weapon.h"
 
-enum BillboardType {
+enum BillboardType : uint8_t {
     Billboard_FacingCamera,
     Billboard_FixedFlat,
     Billboard_Decal,
@@ -13,19 +14,22 @@ enum BillboardType {
 };
 
 struct BillboardDrawRequest {
-    BillboardType type;
     Vector3 position;
-    Texture2D texture;
     Rectangle sourceRect;
     float size;
-    Color tint;
-    float distanceToCamera;
+    float distanceSqr;     // to the camera, sort key only
     float rotationY;
+    Color tint;
+    uint16_t textureIndex; // BillboardTextureIndex(), valid for the frame it was gathered in
+    BillboardType type;
     bool isPortal;
 };
 
 extern std::vector<BillboardDrawRequest> billboardRequests;
 
+// Registers a texture for this frame's requests. The table is rebuilt every gather, together with the list.
+uint16_t BillboardTextureIndex(const Texture2D& texture);
+
 void GatherTransparentDrawRequests(Camera& camera, float deltaTime);
 void DrawTransparentDrawRequests(Camera& camera);
 void GatherDoors(Camera& camera);
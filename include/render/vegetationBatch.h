@@ -0,0 +1,25 @@
+#pragma once
+#include "raylib.h"
+
+// Instanced vegetation with distance LOD. At level load every vegetation model gets a simplified copy
+// of its meshes and a side-on impostor texture. Each frame the visible instances are bucketed by model
+// and distance: near ones draw the full mesh and mid-range ones the simplified mesh, both with one
+// DrawMeshInstanced per mesh, and far ones become camera-facing quads in one batch per model.
+
+enum VegetationKind {
+    VEG_PALM_TREE, // "palmTree"
+    VEG_PALM2,     // "palm2"
+    VEG_BUSH,      // "bush"
+    VEG_KIND_COUNT
+};
+
+// Needs the GL context, the impostors are rendered into textures.
+void BuildVegetationLods();
+void UnloadVegetationLods();
+
+// Cull against the view frustum and bucket one instance by its distance to cameraPos. Same transform as
+// DrawModelEx(model, position, {0,1,0}, rotationY, {scale,scale,scale}).
+void QueueVegetation(VegetationKind kind, Vector3 position, float rotationY, float scale, Vector3 cameraPos);
+
+// Submit and clear everything queued since the last call.
+void DrawQueuedVegetation(Vector3 cameraPos);
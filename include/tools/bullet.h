@@ -2,6 +2,7 @@
 #include "raylib.h"
 #include <climits>
 #include "util/emitter.h"
+#include "util/collisionWorld.h"
 
 enum class BulletType {
     Default,
@@ -67,6 +68,8 @@ public:
     float explosionTimer = 0.0f;
     bool launcher = false;
     BulletType type = BulletType::Default;
+    uint32_t collisionLayer = LAYER_PLAYER_PROJECTILE;
+    uint32_t collisionMask = LAYER_ENEMY | LAYER_STATIC | LAYER_DESTRUCTIBLE;
     Vector3 GetPosition() const;
     Vector3 prevPosition;
     int curTileX = INT_MIN, curTileY = INT_MIN;
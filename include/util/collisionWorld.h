@@ -0,0 +1,125 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "raylib.h"
+
+// Collision layers. Every collider and body carries a layer (what it is) and a mask (what it reacts to).
+// A pair is only tested when each side's layer is in the other side's mask. layer 0 = switched off
+// (open door panel, destroyed web, dead enemy...), so it gets rejected before any geometry test.
+enum CollisionLayer : uint32_t {
+    LAYER_NONE              = 0,
+    LAYER_PLAYER            = 1u << 0,
+    LAYER_ENEMY             = 1u << 1,
+    LAYER_ENEMY_PROJECTILE  = 1u << 2,
+    LAYER_PLAYER_PROJECTILE = 1u << 3,
+    LAYER_STATIC            = 1u << 4,
+    LAYER_DESTRUCTIBLE      = 1u << 5,
+    LAYER_TRIGGER           = 1u << 6,
+};
+
+constexpr uint32_t LAYER_PROJECTILES = LAYER_PLAYER_PROJECTILE | LAYER_ENEMY_PROJECTILE;
+constexpr uint32_t LAYER_CHARACTERS  = LAYER_PLAYER | LAYER_ENEMY;
+
+inline bool LayersInteract(uint32_t layerA, uint32_t maskA, uint32_t layerB, uint32_t maskB) {
+    return (layerA & maskB) != 0 && (layerB & maskA) != 0;
+}
+
+// Which kind of object a batched collider stands for. Order matters: the bullet
+// resolution pass walks hits in this order, same priority the old per-bullet loops had.
+enum class ColliderKind : uint8_t {
+    Player,
+    Enemy,
+    Wall,
+    Door,      // closed door panel
+    DoorSide,  // archway side collider of an open door
+    Pillar,
+    Web,
+    Barrel,
+    Chest,     // character-only from here on, bullets never see these
+    Launcher,
+};
+
+// Structure-of-arrays box list. Padded to a multiple of 4 with boxes that can never be hit,
+// so the test kernel never needs a scalar tail.
+struct ColliderSoA {
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+    std::vector<float> radiusScale;   // 0 = point test (walls, doors, pillars), 1 = sphere test with bullet radius
+    std::vector<uint32_t> layer;
+    std::vector<uint32_t> mask;
+    std::vector<ColliderKind> kind;
+    std::vector<int> owner;           // index into the owning vector (wallRunColliders, doors, enemyPtrs...)
+    std::vector<int> sub;             // side collider index for DoorSide, -1 otherwise
+    size_t count = 0;                 // real colliders, excluding padding
+
+    void Clear();
+    void Reserve(size_t n);
+    void Push(const BoundingBox& box, ColliderKind k, int ownerIndex, float radiusScale,
+              uint32_t layer, uint32_t mask, int subIndex = -1);
+    void Pad();
+    size_t Size() const { return minX.size(); }
+};
+
+// Structure-of-arrays snapshot of the live bullets for one collision pass.
+struct BulletSoA {
+    std::vector<float> px, py, pz, r;
+    std::vector<uint32_t> layer, mask;
+    std::vector<int> index;           // index into the gathered Bullet* list
+
+    void Clear();
+    size_t Size() const { return px.size(); }
+};
+
+struct BulletHit {
+    int bullet;
+    ColliderKind kind;
+    int owner;
+    int sub;
+};
+
+// A box a character is touching (or close to) this tick.
+struct ContactBox {
+    BoundingBox box;
+    ColliderKind kind;
+    int owner;
+    int sub;
+};
+
+// Uniform XZ grid over the static set. The static SoA is stored cell by cell (colliders that
+// straddle cells are duplicated), each cell range padded to 4 so the kernel can run on it directly.
+struct ColliderGrid {
+    float originX = 0.0f, originZ = 0.0f;
+    float cellSize = 800.0f;
+    int cellsX = 0, cellsZ = 0;
+    std::vector<uint32_t> cellStart, cellEnd;
+    std::vector<uint32_t> cellLayers;  // union of the layers in the cell, lets a query skip the whole cell
+
+    void Clear();
+};
+
+extern ColliderSoA gStaticColliders;   // walls, pillars, chests, launchers, built once per level
+extern ColliderGrid gStaticGrid;
+extern ColliderSoA gDynamicColliders;  // player, enemies, doors, webs, barrels, rebuilt every frame
+
+void BuildStaticColliders();
+void ClearStaticColliders();
+void BuildDynamicColliders();
+
+// Appends the index of every box in [begin, end) that the body's layer/mask accepts and that overlaps
+// the sphere. Non-solid bodies (bullets) scale the radius per collider, so radius 0 is a point test.
+// begin and end must be multiples of 4.
+void SphereVsBoxes(const ColliderSoA& set, size_t begin, size_t end,
+                   float px, float py, float pz, float radius, bool solid,
+                   uint32_t bodyLayer, uint32_t bodyMask, std::vector<int>& outHits);
+
+// Broadphase over both sets: grid cells of the static set the sphere touches, then the dynamic set.
+// Cells whose layers the body doesn't care about are skipped whole.
+void QuerySphere(float px, float py, float pz, float radius, uint32_t bodyLayer, uint32_t bodyMask,
+                 std::vector<BulletHit>& outHits, int bodyIndex);
+
+// Character query: every box the body's layer/mask accepts within radius of center, sorted by kind.
+void QueryContacts(Vector3 center, float radius, uint32_t bodyLayer, uint32_t bodyMask, std::vector<ContactBox>& outContacts);
+
+// Runs every bullet through the broadphase and fills hits, sorted by bullet then kind, duplicates removed.
+void CollectBulletHits(const BulletSoA& bullets, std::vector<BulletHit>& hits);
@@ -0,0 +1,41 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fixed pool of worker threads for data-parallel work on the main loop.
+// ParallelFor blocks until every chunk is done, the calling thread helps out. Main thread only, not reentrant.
+class JobPool {
+public:
+    JobPool();
+    ~JobPool();
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    static JobPool& Get(); // Singleton
+
+    // Runs fn(begin, end) over [0, count) in chunks of at least grain items.
+    void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+    size_t WorkerCount() const { return workers.size(); }
+
+private:
+    void WorkerLoop();
+    bool RunOneChunk();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void(size_t, size_t)>* job = nullptr;
+    size_t jobCount = 0;
+    size_t jobGrain = 1;
+    size_t nextIndex = 0;
+    size_t chunksLeft = 0;
+    unsigned generation = 0;
+    bool quitting = false;
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include "raylib.h"
+
+// Tile-to-tile potentially visible set for the current dungeon, baked once at level load.
+// Answers "could anything in tile A see anything in tile B" against the wall colliders,
+// with closed doors as the only thing that changes at runtime. Conservative: false means
+// definitely blocked, true means cast the real ray. Unknown (no dungeon, out of range) is true.
+// The bake tests sampled rays against walls shrunk by the sample spacing, so a sight line that passes
+// between the samples still counts as visible.
+
+void BuildDungeonPVS();
+void ClearDungeonPVS();
+
+bool PVSTileVisible(int ax, int ay, int bx, int by);   // image tile coords
+bool PVSWorldVisible(Vector3 from, Vector3 to);
+
+// Render culling: pick the camera's row once per frame, then test draw positions against it.
+void PVSBeginView(Vector3 cameraPos);
+bool PVSInView(Vector3 worldPos, float radius);
+
+// The fine wall grid the PVS is baked from, shared with the static light bake. cellsPerTile x cellsPerTile
+// cells per tile, cell (0,0) starts at the world XZ origin, 1 = blocks. Walls and doorway sides only, no doors.
+// cells is null when there's no dungeon.
+struct PVSOccluderGrid {
+    const uint8_t* cells = nullptr;
+    int w = 0, h = 0;
+    int cellsPerTile = 0;
+};
+PVSOccluderGrid GetPVSOccluderGrid();
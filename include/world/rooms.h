@@ -0,0 +1,18 @@
+#pragma once
+#include "raylib.h"
+
+// Room/portal occlusion for the current dungeon. At load the walkable tiles are flood filled into rooms,
+// split by the doorway tiles GenerateDoorways places, and every doorway becomes a portal between the two
+// rooms on either side. Each frame the camera's room is walked outwards through portals whose door is
+// open, narrowing the view frustum to each opening, so closed doors and rooms round the corner drop out.
+// Works on top of the PVS: the PVS answers "could this tile ever be seen from here", rooms answer
+// "is it inside what the camera is looking through right now". Unknown (no dungeon, camera in a wall) is true.
+
+void BuildDungeonRooms();
+void ClearDungeonRooms();
+
+// After BeginCustom3D, it reads the view frustum.
+void RoomsBeginView(Vector3 cameraPos);
+
+// True if any tile within radius (XZ) belongs to, or borders, a room the camera can see into.
+bool RoomsInView(Vector3 worldPos, float radius);
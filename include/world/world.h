@@ -19,9 +19,8 @@ enum class GameState {
 // Globals or in a FadeController:
 enum class FadePhase { Idle, FadingOut, Swapping, FadingIn };
 
-extern Model terrainModel;
+extern Material terrainMaterial; //drawn through DrawTerrainChunks
 extern Image heightmap;
-extern Mesh terrainMesh;
 extern Vector3 terrainScale;
 
 //gobal vars
@@ -96,6 +95,7 @@ void generateTrex(int amount, Vector3 centerPos, float radius);
 //void BeginCustom3D(Camera3D camera, float farClip);
 void GenerateEntrances();
 void HandleWaves();
+void UpdateEnemyVisibility();
 void UpdateEnemies(float deltaTime);
 void DrawEnemyShadows();
 void UpdateMuzzleFlashes(float deltaTime);
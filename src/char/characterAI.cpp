@@ -7,6 +7,7 @@
 #include "util/resourceManager.h"
 #include "util/utilities.h"
 #include "world/dungeonGeneration.h"
+#include "world/pvs.h"
 #include "world/world.h"
 
 void Character::UpdateAI(float deltaTime, Player& player) {
@@ -38,8 +39,25 @@ void Character::UpdateAI(float deltaTime, Player& player) {
     }
 }
 
-void Character::UpdatePlayerVisibility(const Vector3& playerPos, float deltaTime, float epsilon) {
-    canSee = HasWorldLineOfSight(position, playerPos, epsilon);
+// Read-only against the level and this character, safe to run on the job pool.
+// Results are picked up by UpdatePlayerVisibility / UpdateRaptorVisibility in the AI update.
+void Character::ComputePlayerLOS(const Vector3& playerPos, bool playerInWater) {
+    if (type == CharacterType::Raptor || type == CharacterType::Trex) {
+        const float VISION_ENTER = 4000.0f;
+        const float VISION_EXIT  = 4200.0f;  // deadband so it doesn’t flicker at the edge
+
+        // Engageable == in range AND not in water
+        const float d = Vector3Distance(position, playerPos);
+        bool inRange = (playerVisible ? d < VISION_EXIT : d < VISION_ENTER);
+        losToPlayer = inRange && !playerInWater;
+    } else {
+        // PVS rejects most blocked pairs with a bit lookup, only cast the ray when it might see
+        losToPlayer = PVSWorldVisible(position, playerPos) && HasWorldLineOfSight(position, playerPos, 0.0f);
+    }
+}
+
+void Character::UpdatePlayerVisibility(const Vector3& playerPos, float deltaTime) {
+    canSee = losToPlayer;
 
     if (canSee) {
         lastKnownPlayerPos = playerPos;
@@ -59,7 +77,7 @@ void Character::UpdateSkeletonAI(float deltaTime, Player& player) {
     float distance = Vector3Distance(position, player.position);
 
     playerVisible = false;
-    UpdatePlayerVisibility(player.position, deltaTime, 0.0f);
+    UpdatePlayerVisibility(player.position, deltaTime);
 
  
     switch (state){
@@ -566,7 +584,7 @@ void Character::UpdatePirateAI(float deltaTime, Player& player) {
     playerVisible = false;
     Vector2 start = WorldToImageCoords(position);
 
-    UpdatePlayerVisibility(player.position, deltaTime, 0.0f);
+    UpdatePlayerVisibility(player.position, deltaTime);
 
  
     switch (state){
@@ -911,6 +929,7 @@ void Character::AlertNearbySkeletons(Vector3 alertOrigin, float radius) {
         if (distSqr > radius * radius) continue;
 
         Vector2 targetTile = WorldToImageCoords(other.position);
+        if (!PVSTileVisible((int)originTile.x, (int)originTile.y, (int)targetTile.x, (int)targetTile.y)) continue;
         if (!LineOfSightRaycast(originTile, targetTile, dungeonImg, 60, 0.0f)) continue;
 
         // Passed all checks → alert the skeleton
@@ -1013,16 +1032,7 @@ void Character::SetPathTo(const Vector3& goalWorld) {
 
 // Call this for raptors/Trex (overworld)
 void Character::UpdateRaptorVisibility(const Player& player, float deltaTime) {
-    const float VISION_ENTER = 4000.0f; 
-    const float VISION_EXIT  = 4200.0f;  // deadband so it doesn’t flicker at the edge
-    const float WATER_LEVEL  = 65.0f;
-
-    const float d = Vector3Distance(position, player.position);
-    const bool playerInWater = IsWaterAtXZ(player.position.x, player.position.z, WATER_LEVEL);
-    
-    // Engageable == in range AND not in water
-    bool inRange = (playerVisible ? d < VISION_EXIT : d < VISION_ENTER);
-    canSee = inRange && !playerInWater;   // instantaneous gate for actions
+    canSee = losToPlayer;   // instantaneous gate for actions, range + water test done in ComputePlayerLOS
 
     if (canSee) {
         playerVisible = true;
@@ -81,6 +81,7 @@ int main() {
         //update context
 
         ResourceManager::Get().UpdateShaders(camera);
+        UpdateEnemyVisibility();
         UpdateEnemies(deltaTime);
         UpdateBullets(camera, deltaTime);
         GatherFrameLights();
@@ -105,14 +106,13 @@ int main() {
             HandleDungeonTints();
         }
 
-        //gather up everything 2d and put it into a vector of struct drawRequests, then we sort and draw every billboard/quad in the game.
-        GatherTransparentDrawRequests(camera, deltaTime);
-
         // Update camera based on player
         UpdateWorldFrame(deltaTime, player);
         UpdatePlayer(player, deltaTime, camera);
         
-        if (!isLoadingLevel && isDungeon) BuildDynamicLightmapFromFrameLights(frameLights);
+        if (!isLoadingLevel && isDungeon) {
+            UpdateLightmapPages(player.position);
+        }
 
         RenderFrame(camera, player, deltaTime); //draw everything
         
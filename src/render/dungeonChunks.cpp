@@ -0,0 +1,163 @@
+#include "render/dungeonChunks.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include "raymath.h"
+#include "render/frustum.h"
+#include "render/renderQueue.h"
+#include "util/job_pool.h"
+#include "world/pvs.h"
+#include "world/rooms.h"
+
+struct ChunkPiece {
+    int chunk;        // index into gChunks, filled in by BuildDungeonChunks
+    int tileX, tileY;
+    Matrix transform; // model.transform * scale * rotation * translation
+};
+
+struct ChunkLayerPieces {
+    const Model* model = nullptr;
+    std::vector<ChunkPiece> pieces;
+};
+
+struct DungeonChunk {
+    std::vector<Mesh> meshes[CHUNK_LAYER_COUNT]; // one per model mesh, empty when the layer has nothing here
+    BoundingBox bounds = { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+};
+
+static ChunkLayerPieces gLayers[CHUNK_LAYER_COUNT];
+static std::vector<DungeonChunk> gChunks;
+static int gChunksX = 0, gChunksZ = 0;
+
+void AddDungeonChunkPiece(DungeonChunkLayer layer, int tileX, int tileY, const Model& model,
+                          Vector3 position, Vector3 rotationAxis, float rotationAngle, Vector3 scale) {
+    Matrix matScale = MatrixScale(scale.x, scale.y, scale.z);
+    Matrix matRotation = MatrixRotate(rotationAxis, rotationAngle * DEG2RAD);
+    Matrix matTranslation = MatrixTranslate(position.x, position.y, position.z);
+    Matrix matTransform = MatrixMultiply(MatrixMultiply(matScale, matRotation), matTranslation);
+
+    gLayers[layer].model = &model;
+    gLayers[layer].pieces.push_back({ -1, tileX, tileY, MatrixMultiply(model.transform, matTransform) });
+}
+
+void ClearDungeonChunkLayer(DungeonChunkLayer layer) {
+    gLayers[layer].model = nullptr;
+    gLayers[layer].pieces.clear();
+}
+
+void UnloadDungeonChunks() {
+    for (DungeonChunk& chunk : gChunks) {
+        for (std::vector<Mesh>& meshes : chunk.meshes) {
+            for (Mesh& mesh : meshes) UnloadMesh(mesh);
+        }
+    }
+    gChunks.clear();
+    gChunksX = gChunksZ = 0;
+    for (int l = 0; l < CHUNK_LAYER_COUNT; ++l) ClearDungeonChunkLayer((DungeonChunkLayer)l);
+}
+
+// Bakes every piece in `which` into one mesh, world space, no index buffer. The source meshes are small but a
+// chunk of walls can pass the 65535 vertices a 16 bit index buffer reaches, so indexed sources get expanded.
+static Mesh MergeChunkMesh(const Mesh& src, const std::vector<ChunkPiece>& pieces, const std::vector<int>& which,
+                           BoundingBox& bounds) {
+    const int srcVerts = src.indices ? src.triangleCount * 3 : src.vertexCount;
+
+    Mesh out = {};
+    out.vertexCount = srcVerts * (int)which.size();
+    out.triangleCount = out.vertexCount / 3;
+    out.vertices = (float*)MemAlloc(out.vertexCount * 3 * sizeof(float));
+    if (src.texcoords) out.texcoords = (float*)MemAlloc(out.vertexCount * 2 * sizeof(float));
+    if (src.normals) out.normals = (float*)MemAlloc(out.vertexCount * 3 * sizeof(float));
+
+    int v = 0;
+    for (int p : which) {
+        const Matrix& m = pieces[p].transform;
+        const Matrix nm = MatrixTranspose(MatrixInvert(m)); // translation lands in m3/m7/m11, which Vector3Transform ignores
+
+        for (int k = 0; k < srcVerts; ++k, ++v) {
+            const int s = src.indices ? src.indices[k] : k;
+
+            Vector3 pos = Vector3Transform({ src.vertices[s*3], src.vertices[s*3 + 1], src.vertices[s*3 + 2] }, m);
+            out.vertices[v*3] = pos.x; out.vertices[v*3 + 1] = pos.y; out.vertices[v*3 + 2] = pos.z;
+            bounds.min = Vector3Min(bounds.min, pos);
+            bounds.max = Vector3Max(bounds.max, pos);
+
+            if (out.texcoords) {
+                out.texcoords[v*2] = src.texcoords[s*2];
+                out.texcoords[v*2 + 1] = src.texcoords[s*2 + 1];
+            }
+            if (out.normals) {
+                Vector3 n = Vector3Normalize(Vector3Transform({ src.normals[s*3], src.normals[s*3 + 1], src.normals[s*3 + 2] }, nm));
+                out.normals[v*3] = n.x; out.normals[v*3 + 1] = n.y; out.normals[v*3 + 2] = n.z;
+            }
+        }
+    }
+    return out;
+}
+
+void BuildDungeonChunks(int tilesW, int tilesH) {
+    for (DungeonChunk& chunk : gChunks) {
+        for (std::vector<Mesh>& meshes : chunk.meshes) {
+            for (Mesh& mesh : meshes) UnloadMesh(mesh);
+        }
+    }
+
+    gChunksX = std::max(1, (tilesW + kChunkTiles - 1) / kChunkTiles);
+    gChunksZ = std::max(1, (tilesH + kChunkTiles - 1) / kChunkTiles);
+    gChunks.assign((size_t)gChunksX * gChunksZ, DungeonChunk{});
+
+    // bucket the pieces by chunk, per layer
+    std::vector<std::vector<int>> buckets[CHUNK_LAYER_COUNT];
+    for (int l = 0; l < CHUNK_LAYER_COUNT; ++l) {
+        buckets[l].assign(gChunks.size(), {});
+        std::vector<ChunkPiece>& pieces = gLayers[l].pieces;
+        for (int i = 0; i < (int)pieces.size(); ++i) {
+            const int cx = std::clamp(pieces[i].tileX / kChunkTiles, 0, gChunksX - 1);
+            const int cz = std::clamp(pieces[i].tileY / kChunkTiles, 0, gChunksZ - 1);
+            pieces[i].chunk = cz * gChunksX + cx;
+            buckets[l][pieces[i].chunk].push_back(i);
+        }
+    }
+
+    // CPU side merge on the workers, each chunk only touches its own slot
+    JobPool::Get().ParallelFor(gChunks.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            DungeonChunk& chunk = gChunks[c];
+            for (int l = 0; l < CHUNK_LAYER_COUNT; ++l) {
+                const Model* model = gLayers[l].model;
+                if (!model || buckets[l][c].empty()) continue;
+                for (int i = 0; i < model->meshCount; ++i) {
+                    chunk.meshes[l].push_back(MergeChunkMesh(model->meshes[i], gLayers[l].pieces, buckets[l][c], chunk.bounds));
+                }
+            }
+        }
+    });
+
+    // GL upload has to happen on the thread that owns the context
+    for (DungeonChunk& chunk : gChunks) {
+        for (std::vector<Mesh>& meshes : chunk.meshes) {
+            for (Mesh& mesh : meshes) UploadMesh(&mesh, false);
+        }
+    }
+}
+
+void DrawDungeonChunks(DungeonChunkLayer layer, Color tint) {
+    const Model* model = gLayers[layer].model;
+    if (!model || gChunks.empty()) return;
+
+    for (const DungeonChunk& chunk : gChunks) {
+        const std::vector<Mesh>& meshes = chunk.meshes[layer];
+        if (meshes.empty()) continue;
+        if (!BoxInView(chunk.bounds)) continue;
+
+        const Vector3 center = Vector3Scale(Vector3Add(chunk.bounds.min, chunk.bounds.max), 0.5f);
+        const float radius = 0.5f * std::max(chunk.bounds.max.x - chunk.bounds.min.x, chunk.bounds.max.z - chunk.bounds.min.z);
+        if (!PVSInView(center, radius) || !RoomsInView(center, radius)) continue;
+
+        for (int i = 0; i < (int)meshes.size(); ++i) {
+            RenderQueuePush(meshes[i], model->materials[model->meshMaterial[i]], MatrixIdentity(), tint, center);
+        }
+    }
+}
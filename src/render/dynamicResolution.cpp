@@ -0,0 +1,59 @@
+#include "render/dynamicResolution.h"
+
+#include <algorithm>
+
+static const float kTargetFrameTime = 1.0f / 60.0f; // SetTargetFPS(60)
+static const float kScaleStep = 0.1f;               // every step reallocates the scene targets
+static const int kMaxSteps = (int)((kMaxRenderScale - kMinRenderScale) / kScaleStep + 0.5f);
+static const float kOverBudget = 1.05f;             // smoothed frame time above target * this drops a step
+static const float kUnderBudget = 1.02f;            // ...below target * this counts towards raising one
+static const float kMinStepInterval = 0.5f;         // seconds between drops, lets the average settle
+static const float kRaiseDelay = 2.0f;              // seconds in budget before trying a step up
+static const float kMaxRaiseDelay = 16.0f;
+static const float kProbeWindow = 3.0f;             // a drop this soon after a raise means the raise didn't fit
+static const float kHitchFrameTime = 0.25f;         // level loads, window drags. not a load we can scale away
+
+static int gSteps = 0; // steps below kMaxRenderScale
+static float gAverage = kTargetFrameTime;
+static float gSinceChange = 0.0f;
+static float gInBudget = 0.0f;
+static float gRaiseDelay = kRaiseDelay;
+static bool gProbing = false; // last change was a raise, still inside kProbeWindow
+
+void UpdateDynamicResolution(float frameTime) {
+    if (frameTime <= 0.0f || frameTime > kHitchFrameTime) {
+        gInBudget = 0.0f;
+        return;
+    }
+
+    gAverage += (frameTime - gAverage) * 0.1f; // about 10 frames
+    gSinceChange += frameTime;
+    if (gProbing && gSinceChange > kProbeWindow) {
+        gProbing = false;
+        gRaiseDelay = kRaiseDelay; // the raise held
+    }
+
+    if (gAverage > kTargetFrameTime * kOverBudget) {
+        gInBudget = 0.0f;
+        if (gSinceChange < kMinStepInterval || gSteps == kMaxSteps) return;
+
+        // backed off right after stepping up: wait longer before the next try so we don't flip every few seconds
+        if (gProbing) gRaiseDelay = std::min(gRaiseDelay * 2.0f, kMaxRaiseDelay);
+        gProbing = false;
+        ++gSteps;
+        gSinceChange = 0.0f;
+        return;
+    }
+
+    gInBudget = (gAverage < kTargetFrameTime * kUnderBudget) ? gInBudget + frameTime : 0.0f;
+    if (gInBudget >= gRaiseDelay && gSteps > 0) {
+        --gSteps;
+        gSinceChange = 0.0f;
+        gInBudget = 0.0f;
+        gProbing = true;
+    }
+}
+
+float GetRenderScale() {
+    return kMaxRenderScale - gSteps * kScaleStep;
+}
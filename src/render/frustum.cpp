@@ -0,0 +1,84 @@
+#include "render/frustum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include "raymath.h"
+
+static Frustum gViewFrustum;
+static bool gViewFrustumValid = false;
+
+static Vector4 NormalizePlane(Vector4 p) {
+    const float len = sqrtf(p.x*p.x + p.y*p.y + p.z*p.z);
+    return (len > 0.0f) ? Vector4Scale(p, 1.0f / len) : p;
+}
+
+// Gribb/Hartmann, rows of view * projection in raylib's column-major layout
+Frustum FrustumFromMatrices(Matrix view, Matrix projection) {
+    const Matrix m = MatrixMultiply(view, projection);
+    const Vector4 row0 = { m.m0, m.m4, m.m8,  m.m12 };
+    const Vector4 row1 = { m.m1, m.m5, m.m9,  m.m13 };
+    const Vector4 row2 = { m.m2, m.m6, m.m10, m.m14 };
+    const Vector4 row3 = { m.m3, m.m7, m.m11, m.m15 };
+
+    Frustum f;
+    f.planes[0] = NormalizePlane(Vector4Add(row3, row0));      // left
+    f.planes[1] = NormalizePlane(Vector4Subtract(row3, row0)); // right
+    f.planes[2] = NormalizePlane(Vector4Add(row3, row1));      // bottom
+    f.planes[3] = NormalizePlane(Vector4Subtract(row3, row1)); // top
+    f.planes[4] = NormalizePlane(Vector4Add(row3, row2));      // near
+    f.planes[5] = NormalizePlane(Vector4Subtract(row3, row2)); // far
+    return f;
+}
+
+bool FrustumHasSphere(const Frustum& frustum, Vector3 center, float radius) {
+    for (const Vector4& p : frustum.planes) {
+        if (p.x*center.x + p.y*center.y + p.z*center.z + p.w < -radius) return false;
+    }
+    return true;
+}
+
+bool FrustumHasBox(const Frustum& frustum, const BoundingBox& box) {
+    for (const Vector4& p : frustum.planes) {
+        // corner furthest along the plane normal
+        const float x = p.x >= 0.0f ? box.max.x : box.min.x;
+        const float y = p.y >= 0.0f ? box.max.y : box.min.y;
+        const float z = p.z >= 0.0f ? box.max.z : box.min.z;
+        if (p.x*x + p.y*y + p.z*z + p.w < 0.0f) return false;
+    }
+    return true;
+}
+
+void SetViewFrustum(const Frustum& frustum) {
+    gViewFrustum = frustum;
+    gViewFrustumValid = true;
+}
+
+const Frustum& GetViewFrustum() {
+    return gViewFrustum;
+}
+
+bool SphereInView(Vector3 center, float radius) {
+    return !gViewFrustumValid || FrustumHasSphere(gViewFrustum, center, radius);
+}
+
+bool BoxInView(const BoundingBox& box) {
+    return !gViewFrustumValid || FrustumHasBox(gViewFrustum, box);
+}
+
+float ModelCullRadius(const Model& model) {
+    static std::unordered_map<const Mesh*, float> cache;
+
+    auto it = cache.find(model.meshes);
+    if (it != cache.end()) return it->second;
+
+    // farthest bounds corner from the origin, so the sphere survives rotation about the origin
+    const BoundingBox b = GetModelBoundingBox(model);
+    const float x = std::max(fabsf(b.min.x), fabsf(b.max.x));
+    const float y = std::max(fabsf(b.min.y), fabsf(b.max.y));
+    const float z = std::max(fabsf(b.min.z), fabsf(b.max.z));
+    const float r = sqrtf(x*x + y*y + z*z);
+
+    cache[model.meshes] = r;
+    return r;
+}
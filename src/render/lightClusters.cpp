@@ -0,0 +1,108 @@
+#include "render/lightClusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include "raymath.h"
+#include "world/world.h"
+
+static const int kClusterTiles = 2; // cell edge in dungeon tiles, grows if the map is too wide for the texture
+
+static Texture2D gClusterTex = {0, 0, 0, 0, 0};
+static std::vector<float> gClusterData;   // kClusterDataWidth * rows * 4
+static std::vector<int> gCellCounts;
+static int gCellsX = 0, gCellsZ = 0;
+static float gCellSize = 1.0f;
+static float gMinX = 0.0f, gMinZ = 0.0f;
+
+static inline float* ClusterTexel(int x, int y) {
+    return &gClusterData[((size_t)y * kClusterDataWidth + x) * 4];
+}
+
+void UnloadLightClusters() {
+    if (gClusterTex.id != 0) UnloadTexture(gClusterTex);
+    gClusterTex = {0, 0, 0, 0, 0};
+    gClusterData.clear();
+    gCellCounts.clear();
+    gCellsX = gCellsZ = 0;
+}
+
+void InitLightClusters(float minX, float minZ, float sizeX, float sizeZ) {
+    UnloadLightClusters();
+
+    // 4 texels per cell, so a row holds kClusterDataWidth / 4 cells
+    const int maxCellsX = kClusterDataWidth / 4;
+    gCellSize = kClusterTiles * tileSize;
+    while ((int)ceilf(sizeX / gCellSize) > maxCellsX) gCellSize *= 2.0f;
+
+    gMinX = minX;
+    gMinZ = minZ;
+    gCellsX = std::max(1, (int)ceilf(sizeX / gCellSize));
+    gCellsZ = std::max(1, (int)ceilf(sizeZ / gCellSize));
+
+    const int lightRows = (kMaxClusterLights * 2 + kClusterDataWidth - 1) / kClusterDataWidth;
+    const int rows = gCellsZ + lightRows;
+    gClusterData.assign((size_t)kClusterDataWidth * rows * 4, 0.0f);
+    gCellCounts.assign((size_t)gCellsX * gCellsZ, 0);
+
+    Image img = { gClusterData.data(), kClusterDataWidth, rows, 1, PIXELFORMAT_UNCOMPRESSED_R32G32B32A32 };
+    gClusterTex = LoadTextureFromImage(img); // copies
+    SetTextureFilter(gClusterTex, TEXTURE_FILTER_POINT); // read with texelFetch anyway
+    SetTextureWrap(gClusterTex, TEXTURE_WRAP_CLAMP);
+}
+
+void BuildLightClusters(const std::vector<LightSample>& lights) {
+    if (gClusterTex.id == 0) return;
+
+    for (int cz = 0; cz < gCellsZ; ++cz) {
+        for (int cx = 0; cx < gCellsX; ++cx) ClusterTexel(cx * 4, cz)[0] = 0.0f;
+    }
+    std::fill(gCellCounts.begin(), gCellCounts.end(), 0);
+
+    const int count = std::min((int)lights.size(), kMaxClusterLights);
+    for (int i = 0; i < count; ++i) {
+        const LightSample& L = lights[i];
+
+        float* rec = ClusterTexel((i * 2) % kClusterDataWidth, gCellsZ + (i * 2) / kClusterDataWidth);
+        rec[0] = L.pos.x; rec[1] = L.pos.y; rec[2] = L.pos.z; rec[3] = L.range;
+        rec[4] = Clamp(L.color.x * L.intensity, 0.0f, 1.0f); // same cap the 8-bit stamp had
+        rec[5] = Clamp(L.color.y * L.intensity, 0.0f, 1.0f);
+        rec[6] = Clamp(L.color.z * L.intensity, 0.0f, 1.0f);
+        rec[7] = 0.0f;
+
+        const int cx0 = std::max(0, (int)floorf((L.pos.x - L.range - gMinX) / gCellSize));
+        const int cx1 = std::min(gCellsX - 1, (int)floorf((L.pos.x + L.range - gMinX) / gCellSize));
+        const int cz0 = std::max(0, (int)floorf((L.pos.z - L.range - gMinZ) / gCellSize));
+        const int cz1 = std::min(gCellsZ - 1, (int)floorf((L.pos.z + L.range - gMinZ) / gCellSize));
+
+        for (int cz = cz0; cz <= cz1; ++cz) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                // circle vs cell rect in XZ
+                const float rx0 = gMinX + cx * gCellSize, rz0 = gMinZ + cz * gCellSize;
+                const float nx = Clamp(L.pos.x, rx0, rx0 + gCellSize) - L.pos.x;
+                const float nz = Clamp(L.pos.z, rz0, rz0 + gCellSize) - L.pos.z;
+                if (nx*nx + nz*nz > L.range * L.range) continue;
+
+                int& n = gCellCounts[(size_t)cz * gCellsX + cx];
+                if (n >= kMaxLightsPerCell) continue;
+                const int slot = ++n;
+                ClusterTexel(cx * 4 + slot / 4, cz)[slot % 4] = (float)i;
+                ClusterTexel(cx * 4, cz)[0] = (float)n;
+            }
+        }
+    }
+
+    UpdateTexture(gClusterTex, gClusterData.data());
+}
+
+void SetLightClusterShaderValues(Shader shader) {
+    int locTex    = GetShaderLocation(shader, "lightClusterTex");
+    int locBounds = GetShaderLocation(shader, "clusterBounds");
+    int locInfo   = GetShaderLocation(shader, "clusterInfo");
+
+    float bounds[4] = { gMinX, gMinZ, 1.0f / gCellSize, 1.0f / gCellSize };
+    int info[4] = { gCellsX, gCellsZ, kClusterDataWidth, 0 };
+
+    if (locBounds >= 0) SetShaderValue(shader, locBounds, bounds, SHADER_UNIFORM_VEC4);
+    if (locInfo   >= 0) SetShaderValue(shader, locInfo,   info,   SHADER_UNIFORM_IVEC4);
+    if (locTex >= 0 && gClusterTex.id != 0) SetShaderValueTexture(shader, locTex, gClusterTex);
+}
@@ -0,0 +1,149 @@
+#include "render/lightStamp.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+void LightAccum16::Reset(int width, int height) {
+    w = width;
+    h = height;
+    const size_t n = (size_t)w * h;
+    r.assign(n, 0);
+    g.assign(n, 0);
+    b.assign(n, 0);
+}
+
+static inline uint16_t AddSat16(uint16_t a, int v) {
+    return (uint16_t)std::min(65535, (int)a + v);
+}
+
+// one texel, also the tail of the SIMD loops
+static inline void StampTexel(uint16_t* r, uint16_t* g, uint16_t* b, int i,
+                              float wx0, float wxStep, float lightX, float dz2, float r2,
+                              float vis, float cr, float cg, float cb) {
+    const float dx = (wx0 + (float)i * wxStep) - lightX;
+    const float d2 = dx * dx + dz2;
+    float t = 1.0f - d2 / r2;
+    t = std::max(t, 0.0f);
+    const float w = t * t * (3.0f - 2.0f * t) * vis;
+    r[i] = AddSat16(r[i], (int)(w * cr));
+    g[i] = AddSat16(g[i], (int)(w * cg));
+    b[i] = AddSat16(b[i], (int)(w * cb));
+}
+
+#if defined(__AVX2__)
+
+// 8 texels: falloff weight * vis
+static inline __m256 Weights8(int i, __m256 lane, __m256 wx0, __m256 step, __m256 lx, __m256 dz2, __m256 r2,
+                              const float* vis) {
+    const __m256 one = _mm256_set1_ps(1.0f), three = _mm256_set1_ps(3.0f), two = _mm256_set1_ps(2.0f);
+    __m256 idx = _mm256_add_ps(_mm256_set1_ps((float)i), lane);
+    __m256 dx = _mm256_sub_ps(_mm256_add_ps(wx0, _mm256_mul_ps(idx, step)), lx);
+    __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), dz2);
+    __m256 t = _mm256_max_ps(_mm256_sub_ps(one, _mm256_div_ps(d2, r2)), _mm256_setzero_ps());
+    __m256 w = _mm256_mul_ps(_mm256_mul_ps(t, t), _mm256_sub_ps(three, _mm256_mul_ps(two, t)));
+    return _mm256_mul_ps(w, _mm256_loadu_ps(vis + i));
+}
+
+static inline void AddChannel8(uint16_t* dst, __m256 w, __m256 c) {
+    __m256i v = _mm256_cvttps_epi32(_mm256_mul_ps(w, c));
+    __m128i v16 = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)); // 0..255, fits
+    __m128i cur = _mm_loadu_si128((const __m128i*)dst);
+    _mm_storeu_si128((__m128i*)dst, _mm_adds_epu16(cur, v16));
+}
+
+void StampLightRow(uint16_t* r, uint16_t* g, uint16_t* b, int count,
+                   float wx0, float wxStep, float lightX, float dz2, float r2,
+                   const float* vis, Color color) {
+    const float cr = color.r, cg = color.g, cb = color.b;
+    const __m256 lane = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 vwx0 = _mm256_set1_ps(wx0), vstep = _mm256_set1_ps(wxStep), vlx = _mm256_set1_ps(lightX);
+    const __m256 vdz2 = _mm256_set1_ps(dz2), vr2 = _mm256_set1_ps(r2);
+    const __m256 vcr = _mm256_set1_ps(cr), vcg = _mm256_set1_ps(cg), vcb = _mm256_set1_ps(cb);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 w = Weights8(i, lane, vwx0, vstep, vlx, vdz2, vr2, vis);
+        AddChannel8(r + i, w, vcr);
+        AddChannel8(g + i, w, vcg);
+        AddChannel8(b + i, w, vcb);
+    }
+    for (; i < count; ++i) StampTexel(r, g, b, i, wx0, wxStep, lightX, dz2, r2, vis[i], cr, cg, cb);
+}
+
+#elif defined(__SSE2__)
+
+// 4 texels: falloff weight * vis
+static inline __m128 Weights4(int i, __m128 lane, __m128 wx0, __m128 step, __m128 lx, __m128 dz2, __m128 r2,
+                              const float* vis) {
+    const __m128 one = _mm_set1_ps(1.0f), three = _mm_set1_ps(3.0f), two = _mm_set1_ps(2.0f);
+    __m128 idx = _mm_add_ps(_mm_set1_ps((float)i), lane);
+    __m128 dx = _mm_sub_ps(_mm_add_ps(wx0, _mm_mul_ps(idx, step)), lx);
+    __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), dz2);
+    __m128 t = _mm_max_ps(_mm_sub_ps(one, _mm_div_ps(d2, r2)), _mm_setzero_ps());
+    __m128 w = _mm_mul_ps(_mm_mul_ps(t, t), _mm_sub_ps(three, _mm_mul_ps(two, t)));
+    return _mm_mul_ps(w, _mm_loadu_ps(vis + i));
+}
+
+// 8 texels per channel: two float quads packed into one row of u16
+static inline void AddChannel8(uint16_t* dst, __m128 w0, __m128 w1, __m128 c) {
+    __m128i lo = _mm_cvttps_epi32(_mm_mul_ps(w0, c));
+    __m128i hi = _mm_cvttps_epi32(_mm_mul_ps(w1, c));
+    __m128i v16 = _mm_packs_epi32(lo, hi); // 0..255, fits
+    __m128i cur = _mm_loadu_si128((const __m128i*)dst);
+    _mm_storeu_si128((__m128i*)dst, _mm_adds_epu16(cur, v16));
+}
+
+void StampLightRow(uint16_t* r, uint16_t* g, uint16_t* b, int count,
+                   float wx0, float wxStep, float lightX, float dz2, float r2,
+                   const float* vis, Color color) {
+    const float cr = color.r, cg = color.g, cb = color.b;
+    const __m128 lane = _mm_setr_ps(0, 1, 2, 3);
+    const __m128 vwx0 = _mm_set1_ps(wx0), vstep = _mm_set1_ps(wxStep), vlx = _mm_set1_ps(lightX);
+    const __m128 vdz2 = _mm_set1_ps(dz2), vr2 = _mm_set1_ps(r2);
+    const __m128 vcr = _mm_set1_ps(cr), vcg = _mm_set1_ps(cg), vcb = _mm_set1_ps(cb);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 w0 = Weights4(i, lane, vwx0, vstep, vlx, vdz2, vr2, vis);
+        __m128 w1 = Weights4(i + 4, lane, vwx0, vstep, vlx, vdz2, vr2, vis);
+        AddChannel8(r + i, w0, w1, vcr);
+        AddChannel8(g + i, w0, w1, vcg);
+        AddChannel8(b + i, w0, w1, vcb);
+    }
+    for (; i < count; ++i) StampTexel(r, g, b, i, wx0, wxStep, lightX, dz2, r2, vis[i], cr, cg, cb);
+}
+
+#else
+
+void StampLightRow(uint16_t* r, uint16_t* g, uint16_t* b, int count,
+                   float wx0, float wxStep, float lightX, float dz2, float r2,
+                   const float* vis, Color color) {
+    const float cr = color.r, cg = color.g, cb = color.b;
+    for (int i = 0; i < count; ++i) StampTexel(r, g, b, i, wx0, wxStep, lightX, dz2, r2, vis[i], cr, cg, cb);
+}
+
+#endif
+
+uint16_t FloatToHalf(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+
+    const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000u);
+    const uint32_t absBits = bits & 0x7FFFFFFFu;
+
+    if (absBits >= 0x7F800000u) return sign | (absBits > 0x7F800000u ? 0x7E00u : 0x7C00u); // nan / inf
+    if (absBits >= 0x477FF000u) return sign | 0x7C00u;  // rounds past 65504
+    if (absBits <  0x38800000u) return sign;            // below 2^-14
+
+    // rebias exponent 127 -> 15, keep 10 mantissa bits, round half to even
+    const uint32_t h = (absBits - 0x38000000u) >> 13;
+    const uint32_t rest = absBits & 0x1FFFu;
+    const uint32_t round = (rest > 0x1000u || (rest == 0x1000u && (h & 1u))) ? 1u : 0u;
+    return (uint16_t)(sign | (h + round));
+}
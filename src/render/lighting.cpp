@@ -1,259 +1,466 @@
 #include "render/lighting.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cfloat>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <thread>
 #include "raymath.h"
-#include "char/pathfinding.h"
+#include "render/lightClusters.h"
+#include "render/lightStamp.h"
+#include "render/lightmapCache.h"
+#include "util/job_pool.h"
+#include "world/pvs.h"
+#include "world/rooms.h"
 #include "world/dungeonGeneration.h"
 #include "world/world.h"
 
 
 BakedLightmap gDynamic; 
 
-static std::vector<Color> gStaticBase;   // same w*h as gDynamic
+// Static light is paged. The map is cut into kLightmapPageTiles square pages at the configured
+// texels-per-tile, and only pages around the player are baked and resident in a fixed atlas. A page
+// table says which atlas slot holds which page. Everything else samples the overview, a whole-map
+// copy at one texel per tile, which is also gDynamic.tex. Memory stays flat however big the map gets.
+//
+// Texels are RGBA16F (4 halves each): linear light where 1.0 is one full-strength light, no clamp,
+// A = lava mask. The lighting shader tone-maps once per fragment. Dynamic lights don't touch any of
+// it, they go through the light cluster list and the shader adds them per fragment (lightClusters.h).
+static const int kLightmapPageTiles = 16;
+static const int kPageResidentRadius = 2;   // pages around the player's page, 5x5
+static const int kAtlasSlotsPerRow = 6;     // 36 slots, the 25 wanted plus room for stragglers
+static const int kMaxPageBakesPerFrame = 4; // the overview covers pages still on their way
+static_assert(kAtlasSlotsPerRow * kAtlasSlotsPerRow >= (2 * kPageResidentRadius + 1) * (2 * kPageResidentRadius + 1),
+              "atlas must hold every wanted page");
+
+static int gTexelsPerTile = 4;
+static int gPageTexels = 0;   // kLightmapPageTiles * gTexelsPerTile
+static int gSlotTexels = 0;   // page plus a 1 texel gutter each side, so bilinear never reads a neighbour slot
+static int gPagesX = 0, gPagesZ = 0;
+
+static std::vector<uint16_t> gOverview;   // CPU copy of the overview, gDynamic.w * gDynamic.h * 4
+static Texture2D gOverviewTex = {0, 0, 0, 0, 0};
+static Texture2D gPageAtlas = {0, 0, 0, 0, 0};
+static Texture2D gPageTableTex = {0, 0, 0, 0, 0};
+static std::vector<float> gPageTable;     // per page: atlas slot, -1 when not resident (R32F)
+static std::vector<int> gSlotPage;        // per slot: page index, -1 when free
+
+// what the static bake reads, kept so pages can bake when they come into range
+static std::vector<LightSource> gBakeLights;
+static std::vector<Color> gBakeColors;
+static uint64_t gBakeBaseHash = 0;   // map + lights, fixed for the level
+static uint64_t gBakeInputsHash = 0; // base + which doors/barrels block right now, keys the cache
+static bool gBaked = false;
+
+static const int kBakeBlockTiles = 8; // overview bake job = 8x8 tiles
+static int gBlocksX = 0, gBlocksZ = 0;
+
+// Which lights reach each page / overview block. Recorded at bake time, a rebake only redoes
+// the regions whose list holds a light that changed.
+static std::vector<std::vector<int>> gPageLights;
+static std::vector<std::vector<int>> gBlockLights;
+
+// Static lights used to be scaled by this after an 8-bit clamp to leave headroom for fireballs.
+// With float texels nothing clips, it's only kept as the exposure balance between static and dynamic lights.
+static const float kStaticLightGain = 0.65f;
+
+// bump when the bake itself changes so old cache files stop matching
+static const uint32_t kStaticBakeVersion = 6;
+
+// Everything the static bake reads: map pixels (walls/doorways/lava come from them), world scale
+// and the light list. Page layout and density go into the per-region key.
+static uint64_t HashStaticBakeInputs(const std::vector<LightSource>& dungeonLights)
+{
+    uint64_t h = HashBytes(&kStaticBakeVersion, sizeof(kStaticBakeVersion));
+    const int dims[2] = { dungeonWidth, dungeonHeight };
+    h = HashBytes(dims, sizeof(dims), h);
+    if (dungeonPixels) h = HashBytes(dungeonPixels, (size_t)dungeonWidth * dungeonHeight * sizeof(Color), h);
+
+    const float world[6] = { tileSize, floorHeight, gDynamic.minX, gDynamic.minZ, gDynamic.sizeX, gDynamic.sizeZ };
+    h = HashBytes(world, sizeof(world), h);
+
+    for (const LightSource& L : dungeonLights) {
+        const float l[8] = { L.position.x, L.position.y, L.position.z, L.range, L.intensity,
+                             L.colorTint.x, L.colorTint.y, L.colorTint.z };
+        h = HashBytes(l, sizeof(l), h);
+    }
+    return h;
+}
 
 
-// --- Helper: stamp a soft radial mask into ALPHA with max-combine
-static inline void StampLavaMaskToAlpha(int tileX, int tileY, float radiusTiles = 0.55f)
-{
-    if (dungeonWidth <= 0 || dungeonHeight <= 0 || gDynamic.w <= 0 || gDynamic.h <= 0) return;
+// A rectangle of lightmap texels at tpt texels per tile, baked on its own. Pages and the overview are
+// both regions. x0/z0 are full-map texels at that density, a page's gutter pokes one texel past the map.
+struct LightmapRegion {
+    int tpt = 1;
+    int x0 = 0, z0 = 0, w = 0, h = 0;
+};
 
-    // dynamic grid scale: texels per tile (assumes divisible)
-    const int sx = gDynamic.w / dungeonWidth;
-    const int sy = gDynamic.h / dungeonHeight;
+static uint64_t RegionCacheKey(const LightmapRegion& reg)
+{
+    const int k[5] = { reg.tpt, reg.x0, reg.z0, reg.w, reg.h };
+    return HashBytes(k, sizeof(k), gBakeInputsHash);
+}
 
-    // Center of this tile in lightmap texels (center of texels)
-    const float cx = (tileX + 0.5f) * sx;
-    const float cy = (tileY + 0.5f) * sy;
+// --- Lava mask for one region, soft radial blob per lava tile (pixel convention: 200,0,0) with max-combine,
+// then a tiny dilate to help thin edges survive mips. Built one texel wider so the dilate sees past the edge.
+static void BuildRegionLavaMask(const LightmapRegion& reg, std::vector<unsigned char>& mask)
+{
+    const int mw = reg.w + 2, mh = reg.h + 2;
+    const int ox = reg.x0 - 1, oz = reg.z0 - 1; // wide buffer origin in map texels
+    std::vector<unsigned char> wide((size_t)mw * mh, 0);
 
-    // Radius in texels (soft falloff to 0 at the rim)
-    const float r  = radiusTiles * 0.5f * (sx + sy); // average to be safe if non-square
+    // Radius in texels (soft falloff to 0 at the rim), slightly > tile center for nicer mips
+    const float r  = 0.65f * reg.tpt;
     const float r2 = r * r;
 
-    int minx = (int)floorf(cx - r); if (minx < 0) minx = 0;
-    int maxx = (int)ceilf (cx + r); if (maxx > gDynamic.w - 1) maxx = gDynamic.w - 1;
-    int miny = (int)floorf(cy - r); if (miny < 0) miny = 0;
-    int maxy = (int)ceilf (cy + r); if (maxy > gDynamic.h - 1) maxy = gDynamic.h - 1;
-
-    for (int y = miny; y <= maxy; ++y) {
-        const float py = (y + 0.5f) - cy;
-        for (int x = minx; x <= maxx; ++x) {
-            const float px = (x + 0.5f) - cx;
-            const float d2 = px*px + py*py;
-            if (d2 > r2) continue;
-
-            // Smooth falloff (1 at center -> 0 at radius)
-            float t = 1.0f - sqrtf(d2) / r;
-            // Optional ease for a nicer shoulder:
-            t = t * t * (3.0f - 2.0f * t); // smoothstep(0,1)
-
-            unsigned char v = (unsigned char)(t * 255.0f);
-            Color &p = gStaticBase[(size_t)y * gDynamic.w + x];
-            if (v > p.a) p.a = v; // MAX-combine for masks
+    const int tx0 = std::max(0, (int)floorf((ox - r) / reg.tpt));
+    const int tx1 = std::min(dungeonWidth - 1, (int)floorf((ox + mw + r) / reg.tpt));
+    const int tz0 = std::max(0, (int)floorf((oz - r) / reg.tpt));
+    const int tz1 = std::min(dungeonHeight - 1, (int)floorf((oz + mh + r) / reg.tpt));
+
+    for (int fy = tz0; fy <= tz1; ++fy) {
+        for (int fx = tx0; fx <= tx1; ++fx) {
+            Color px = GetImageColor(dungeonImg, dungeonWidth - 1 - fx, dungeonHeight - 1 - fy); // image is mirrored
+            if (!(px.r == 200 && px.g == 0 && px.b == 0)) continue;
+
+            // Center of this tile in wide-buffer texels
+            const float cx = (fx + 0.5f) * reg.tpt - ox;
+            const float cy = (fy + 0.5f) * reg.tpt - oz;
+
+            const int minx = std::max(0, (int)floorf(cx - r)), maxx = std::min(mw - 1, (int)ceilf(cx + r));
+            const int miny = std::max(0, (int)floorf(cy - r)), maxy = std::min(mh - 1, (int)ceilf(cy + r));
+            for (int y = miny; y <= maxy; ++y) {
+                const float py = (y + 0.5f) - cy;
+                for (int x = minx; x <= maxx; ++x) {
+                    const float pxd = (x + 0.5f) - cx;
+                    const float d2 = pxd*pxd + py*py;
+                    if (d2 > r2) continue;
+
+                    float t = 1.0f - sqrtf(d2) / r;
+                    t = t * t * (3.0f - 2.0f * t); // smoothstep(0,1)
+
+                    unsigned char v = (unsigned char)(t * 255.0f);
+                    unsigned char& m = wide[(size_t)y * mw + x];
+                    if (v > m) m = v; // MAX-combine for masks
+                }
+            }
         }
     }
-}
 
-// --- Optional: tiny dilation to help thin edges survive mips
-static inline void DilateAlphaOnce()
-{
-    std::vector<unsigned char> tmp((size_t)gDynamic.w * gDynamic.h, 0);
-    for (int y = 0; y < gDynamic.h; ++y) {
-        for (int x = 0; x < gDynamic.w; ++x) {
+    mask.assign((size_t)reg.w * reg.h, 0);
+    for (int y = 0; y < reg.h; ++y) {
+        for (int x = 0; x < reg.w; ++x) {
             unsigned char m = 0;
-            for (int dy = -1; dy <= 1; ++dy) {
-                int yy = y + dy; if (yy < 0 || yy >= gDynamic.h) continue;
-                for (int dx = -1; dx <= 1; ++dx) {
-                    int xx = x + dx; if (xx < 0 || xx >= gDynamic.w) continue;
-                    m = (unsigned char) (m > gStaticBase[(size_t)yy * gDynamic.w + xx].a
-                                         ? m : gStaticBase[(size_t)yy * gDynamic.w + xx].a);
-                }
+            for (int dy = 0; dy <= 2; ++dy) {
+                for (int dx = 0; dx <= 2; ++dx) m = std::max(m, wide[(size_t)(y + dy) * mw + (x + dx)]);
             }
-            tmp[(size_t)y * gDynamic.w + x] = m;
+            mask[(size_t)y * reg.w + x] = m;
         }
     }
-    for (int i = 0, n = (int)tmp.size(); i < n; ++i) gStaticBase[(size_t)i].a = tmp[(size_t)i];
 }
 
-// --- Build lava into ALPHA from your dungeon image (pixel convention: 200,0,0)
-static inline void BuildLavaMaskAlphaFromImage(const Image& dungeonImg)
+// --- Per-light visibility field: recursive shadowcasting on the PVS occluder grid ---
+// One pass per light covers its whole radius. Walls count as lit (their faces catch the light),
+// cells behind them don't. Without an occluder grid everything is visible.
+struct LightVisField {
+    int originX = 0, originZ = 0; // window corner in fine cells
+    int size = 0;                 // window is size x size
+    float cell = 1.0f;            // fine cell size in world units
+    bool open = true;             // no occluders, everything visible
+    std::vector<uint8_t> vis;     // 1 = light reaches this cell
+    std::vector<uint32_t> sat;    // summed-area table of vis, (size+1)^2, for box sampling
+};
+
+static std::vector<LightVisField> gBakeFields; // one per gBakeLights entry
+
+// Field per light by index. Normally points into gBakeFields, a rebake swaps in its new fields.
+using LightFieldTable = std::vector<const LightVisField*>;
+static LightFieldTable gBakeFieldTable;
+
+// octant transforms (xx, xy, yx, yy)
+static const int kOctants[8][4] = {
+    { 1, 0, 0, 1 }, { 0, 1, 1, 0 }, { 0, -1, 1, 0 }, { -1, 0, 0, 1 },
+    { -1, 0, 0, -1 }, { 0, -1, -1, 0 }, { 0, 1, -1, 0 }, { 1, 0, 0, -1 },
+};
+
+static void CastLightOctant(LightVisField& f, const PVSOccluderGrid& grid, int cx, int cz, int radius,
+                            int row, float start, float end, int xx, int xy, int yx, int yy)
 {
-    // Start with alpha = 0 (A now has meaning)
-    for (Color &p : gStaticBase) p.a = 0;
-
-    int lavaCount = 0;
-    for (int ty = 0; ty < dungeonHeight; ++ty) {
-        for (int tx = 0; tx < dungeonWidth; ++tx) {
-            Color px = GetImageColor(dungeonImg, tx, ty);
-            const bool isLava = (px.r == 200 && px.g == 0 && px.b == 0);
-            if (!isLava) continue;
-            ++lavaCount;
+    if (start < end) return;
+    const int r2 = radius * radius;
+    float newStart = 0.0f;
+
+    for (int j = row; j <= radius; ++j) {
+        bool blocked = false;
+        const int dy = -j;
+        for (int dx = -j; dx <= 0; ++dx) {
+            const float lSlope = (dx - 0.5f) / (dy + 0.5f);
+            const float rSlope = (dx + 0.5f) / (dy - 0.5f);
+            if (start < rSlope) continue;
+            if (end > lSlope) break;
+
+            const int gx = cx + dx * xx + dy * xy;
+            const int gz = cz + dx * yx + dy * yy;
+            const bool inGrid = gx >= 0 && gz >= 0 && gx < grid.w && gz < grid.h;
+            const bool wall = !inGrid || grid.cells[gz * grid.w + gx];
+
+            if (dx*dx + dy*dy <= r2) {
+                const int lx = gx - f.originX, lz = gz - f.originZ;
+                if (lx >= 0 && lz >= 0 && lx < f.size && lz < f.size) f.vis[lz * f.size + lx] = 1;
+            }
 
-            int fx = dungeonWidth  - 1 - tx;  // mirror X
-            int fy = dungeonHeight - 1 - ty;  // mirror Y
-            StampLavaMaskToAlpha(fx, fy, /*radiusTiles=*/0.65f);
-            //StampLavaMaskToAlpha(tx, ty, /*radiusTiles=*/0.65f); // slightly > tile center for nicer mips
+            if (blocked) {
+                if (wall) { newStart = rSlope; continue; }
+                blocked = false;
+                start = newStart;
+            } else if (wall && j < radius) {
+                blocked = true;
+                CastLightOctant(f, grid, cx, cz, radius, j + 1, start, lSlope, xx, xy, yx, yy);
+                newStart = rSlope;
+            }
         }
+        if (blocked) break;
     }
+}
 
-    // A tiny dilate helps distant mips hold the glow
-    DilateAlphaOnce();
-
-    TraceLog(LOG_INFO, "[lava alpha] tiles=%d  scale=%dx%d  dyn=%dx%d",
-            lavaCount,
-            gDynamic.w / dungeonWidth, gDynamic.h / dungeonHeight,
-            gDynamic.w, gDynamic.h);
+static void BuildLightVisField(LightVisField& f, const PVSOccluderGrid& grid, const Vector3& lightPos, float radius)
+{
+    f.open = grid.cells == nullptr;
+    if (f.open) return;
+
+    f.cell = tileSize / grid.cellsPerTile;
+    const int cx = (int)floorf(lightPos.x / f.cell);
+    const int cz = (int)floorf(lightPos.z / f.cell);
+    const int r  = (int)ceilf(radius / f.cell) + 2; // +2 so the sampling ring at the rim stays inside
+
+    f.size = 2 * r + 1;
+    f.originX = cx - r;
+    f.originZ = cz - r;
+    f.vis.assign((size_t)f.size * f.size, 0);
+    f.vis[(size_t)r * f.size + r] = 1;
+
+    for (const auto& o : kOctants) CastLightOctant(f, grid, cx, cz, r, 1, 1.0f, 0.0f, o[0], o[1], o[2], o[3]);
+
+    const int n = f.size + 1;
+    f.sat.assign((size_t)n * n, 0);
+    for (int z = 0; z < f.size; ++z) {
+        uint32_t row = 0;
+        for (int x = 0; x < f.size; ++x) {
+            row += f.vis[(size_t)z * f.size + x];
+            f.sat[(size_t)(z + 1) * n + (x + 1)] = f.sat[(size_t)z * n + (x + 1)] + row;
+        }
+    }
 }
 
+// Box-filtered visibility around a world XZ point: every cell whose center is within halfExtent.
+// The soft edge comes from here, a texel straddling a shadow line gets a fraction.
+static float SampleLightVisField(const LightVisField& f, float wx, float wz, float halfExtent)
+{
+    if (f.open) return 1.0f;
+
+    const int fx0 = (int)ceilf ((wx - halfExtent) / f.cell - 0.5f) - f.originX;
+    const int fx1 = (int)floorf((wx + halfExtent) / f.cell - 0.5f) - f.originX;
+    const int fz0 = (int)ceilf ((wz - halfExtent) / f.cell - 0.5f) - f.originZ;
+    const int fz1 = (int)floorf((wz + halfExtent) / f.cell - 0.5f) - f.originZ;
 
+    const int total = std::max(0, fx1 - fx0 + 1) * std::max(0, fz1 - fz0 + 1);
+    if (total == 0) return 0.0f;
 
+    // cells outside the window count as dark
+    const int x0 = std::max(fx0, 0), x1 = std::min(fx1, f.size - 1);
+    const int z0 = std::max(fz0, 0), z1 = std::min(fz1, f.size - 1);
+    if (x0 > x1 || z0 > z1) return 0.0f;
 
+    const int n = f.size + 1;
+    const uint32_t lit = f.sat[(size_t)(z1 + 1) * n + (x1 + 1)] - f.sat[(size_t)z0 * n + (x1 + 1)]
+                       - f.sat[(size_t)(z1 + 1) * n + x0] + f.sat[(size_t)z0 * n + x0];
+    return (float)lit / (float)total;
+}
 
 
-// Returns 0..1 visibility from light -> tileCenter using a small perpendicular ray fan.
-// spreadMeters ~ 0.15f * tileSize; numRays 3..5; epsilonFrac ~ 0.02f
-static float TileVisibilityWorldRay(const Vector3& lightPos,
-                                    const Vector3& tileCenter,
-                                    int numRays, float spreadMeters,
-                                    float originYOffset, float targetYOffset,
-                                    float epsilonFrac)
+// // --- Static bake: row stamping into the 16-bit accumulator, occlusion from the light's visibility field ---
+// acc covers the region. Only touches map texels inside [clipX0..clipX1] x [clipZ0..clipZ1], so disjoint
+// clips can bake in parallel.
+static void StampLight_StaticBase_ToAccum(LightAccum16& acc, const LightmapRegion& reg,
+                                          const Vector3& lightPos, float radius, Color color,
+                                          const LightVisField& field,
+                                          int clipX0, int clipZ0, int clipX1, int clipZ1)
 {
-    // Direction in XZ, build a perpendicular (for fan offsets)
-    Vector3 dirXZ = { tileCenter.x - lightPos.x, 0.0f, tileCenter.z - lightPos.z };
-    float len = sqrtf(dirXZ.x*dirXZ.x + dirXZ.z*dirXZ.z);
-    if (len < 1e-3f) return 1.0f; // same tile
-    Vector3 perp = { -dirXZ.z/len, 0.0f, dirXZ.x/len };
+    const float texel = tileSize / reg.tpt;
+    const float r2 = radius*radius;
 
-    int visible = 0;
-    int rays = (numRays < 1) ? 1 : numRays;
-    float half = 0.5f * (float)(rays - 1);
+    // texel rect: clip intersected with the light's square
+    int x0 = std::max(clipX0, (int)floorf((lightPos.x - radius - gDynamic.minX) / texel));
+    int x1 = std::min(clipX1, (int)ceilf((lightPos.x + radius - gDynamic.minX) / texel));
+    int y0 = std::max(clipZ0, (int)floorf((lightPos.z - radius - gDynamic.minZ) / texel));
+    int y1 = std::min(clipZ1, (int)ceilf((lightPos.z + radius - gDynamic.minZ) / texel));
+    if (x0 > x1 || y0 > y1) return;
 
-    Vector3 from = lightPos; from.y += originYOffset;
+    // sample the texel's own cells plus one ring of neighbours, soft but doesn't bleed through a wall
+    const float sampleHalf = 0.5f * texel + 0.5f * field.cell;
 
-    for (int i = 0; i < rays; ++i) {
-        float t = ((float)i - half);                 // … -2,-1,0,1,2 …
-        Vector3 to = tileCenter;
-        to.x += perp.x * t * spreadMeters;
-        to.z += perp.z * t * spreadMeters;
-        to.y  = tileCenter.y + targetYOffset;
+    static thread_local std::vector<float> visRow;
 
-        if (HasWorldLineOfSight(from, to, epsilonFrac, LOSMode::Lighting)) ++visible;
+    for (int y = y0; y <= y1; ++y) {
+        const float wz  = gDynamic.minZ + (y + 0.5f) * texel;
+        const float dz  = wz - lightPos.z;
+        const float dz2 = dz*dz;
+        if (dz2 > r2) continue;
+
+        // trim the row to the circle, the kernel would only add zeros outside it
+        const float half = sqrtf(r2 - dz2);
+        const int rx0 = std::max(x0, (int)floorf((lightPos.x - half - gDynamic.minX) / texel));
+        const int rx1 = std::min(x1, (int)ceilf ((lightPos.x + half - gDynamic.minX) / texel));
+        if (rx0 > rx1) continue;
+
+        const int count = rx1 - rx0 + 1;
+        const float wx0 = gDynamic.minX + (rx0 + 0.5f) * texel;
+        visRow.resize((size_t)count);
+        for (int i = 0; i < count; ++i) visRow[i] = SampleLightVisField(field, wx0 + i * texel, wz, sampleHalf);
+
+        const size_t off = (size_t)(y - reg.z0) * acc.w + (rx0 - reg.x0);
+        StampLightRow(&acc.r[off], &acc.g[off], &acc.b[off], count,
+                      wx0, texel, lightPos.x, dz2, r2, visRow.data(), color);
     }
-    return (float)visible / (float)rays;
 }
 
-
-// --- 2×2 sub-tile visibility using your world-ray LOS fan ---
-static void SubtileVis2x2(float vis[2][2],
-                          const Vector3& lightPos,
-                          float cx, float cz, float tileSize, float floorY)
+static void StampBakeLights(LightAccum16& acc, const LightmapRegion& reg, const std::vector<int>& lights,
+                            const LightFieldTable& fields, int clipX0, int clipZ0, int clipX1, int clipZ1)
 {
-    // Offsets to centers of the 4 quarters: (-0.25,+0.25) * tileSize
-    const float o = 0.25f * tileSize;
-    const float offs[2] = {-o, +o};
+    for (int i : lights) {
+        const LightSource& L = gBakeLights[i];
+        StampLight_StaticBase_ToAccum(acc, reg, L.position, L.range, gBakeColors[i], *fields[i],
+                                      clipX0, clipZ0, clipX1, clipZ1);
+    }
+}
 
-    for (int sy=0; sy<2; ++sy) {
-        for (int sx=0; sx<2; ++sx) {
-            Vector3 subCenter = { cx + offs[sx], floorY, cz + offs[sy] };
-            // reuse your TileVisibilityWorldRay(lightPos, tileCenter, numRays, spread, originY, targetY, eps)
-            vis[sy][sx] = TileVisibilityWorldRay(lightPos, subCenter,
-                                                 /*numRays=*/6,
-                                                 /*spreadMeters=*/0.25f*tileSize,
-                                                 /*originYOffset=*/2.0f,
-                                                 /*targetYOffset=*/2.0f,
-                                                 /*epsilonFrac=*/0.01f);
-        }
+// lava into A and the one conversion to half floats, nothing clipped
+static void ResolveRegion(const LightAccum16& acc, const LightmapRegion& reg, std::vector<uint16_t>& out)
+{
+    std::vector<unsigned char> lava;
+    BuildRegionLavaMask(reg, lava);
+
+    const float toLinear = kStaticLightGain / 255.0f;
+    out.resize((size_t)reg.w * reg.h * 4);
+    for (size_t i = 0, n = (size_t)reg.w * reg.h; i < n; ++i) {
+        uint16_t* t = &out[i * 4];
+        t[0] = FloatToHalf(acc.r[i] * toLinear);
+        t[1] = FloatToHalf(acc.g[i] * toLinear);
+        t[2] = FloatToHalf(acc.b[i] * toLinear);
+        t[3] = FloatToHalf(lava[i] / 255.0f);
     }
 }
 
+// Serial, page jobs run side by side on the job pool and the rebake thread calls it too.
+static void BakeRegion(const LightmapRegion& reg, const std::vector<int>& lights, const LightFieldTable& fields,
+                       std::vector<uint16_t>& out)
+{
+    LightAccum16 acc;
+    acc.Reset(reg.w, reg.h);
+    StampBakeLights(acc, reg, lights, fields, reg.x0, reg.z0, reg.x0 + reg.w - 1, reg.z0 + reg.h - 1);
+    ResolveRegion(acc, reg, out);
+}
 
+// Disk cache first. Runs on job pool workers: the bake globals it reads only change on the main thread, which
+// waits in ParallelFor meanwhile. Not for the rebake thread, it runs alongside the main thread.
+// EnsureLightmapCacheDir has to run first.
+static void LoadOrBakeRegion(const LightmapRegion& reg, const std::vector<int>& lights, std::vector<uint16_t>& out)
+{
+    const uint64_t key = RegionCacheKey(reg);
+    if (LoadLightmapCache(key, reg.w, reg.h, out)) return;
 
+    BakeRegion(reg, lights, gBakeFieldTable, out);
+    SaveLightmapCache(key, reg.w, reg.h, out);
+}
 
-// // --- Static bake: tile-first stamping with 2×2 sub-tile LOS near occluders ---
-void StampLight_StaticBase_Subtile2x2_ToBuffer(std::vector<Color>& outBuf, int bufW, int bufH,
-                                               const Vector3& lightPos, float radius, Color color)
+static LightmapRegion PageRegion(int page)
 {
-    if ((int)outBuf.size() != bufW*bufH) outBuf.assign((size_t)bufW*bufH, (Color){0,0,0,255});
+    LightmapRegion reg;
+    reg.tpt = gTexelsPerTile;
+    reg.x0 = (page % gPagesX) * gPageTexels - 1; // gutter
+    reg.z0 = (page / gPagesX) * gPageTexels - 1;
+    reg.w = reg.h = gSlotTexels;
+    return reg;
+}
 
-    const int tppX = bufW / dungeonWidth;            // texels-per-tile (X)
-    const int tppZ = bufH / dungeonHeight;            // texels-per-tile (Z)
+// overview block, one texel per tile
+static LightmapRegion BlockRegion(int block)
+{
+    LightmapRegion reg;
+    reg.x0 = (block % gBlocksX) * kBakeBlockTiles;
+    reg.z0 = (block / gBlocksX) * kBakeBlockTiles;
+    reg.w = std::min(kBakeBlockTiles, dungeonWidth  - reg.x0);
+    reg.h = std::min(kBakeBlockTiles, dungeonHeight - reg.z0);
+    return reg;
+}
 
-    const int lx = (int)floorf((lightPos.x - gDynamic.minX) / tileSize);
-    const int lz = (int)floorf((lightPos.z - gDynamic.minZ) / tileSize);
-    const int R  = (int)ceilf(radius / tileSize);
-    const float r2 = radius*radius;
+// Light's square in tiles, one tile wider so page gutters and the texel ring are covered.
+static void LightTileRect(const LightSource& L, int& tx0, int& tz0, int& tx1, int& tz1)
+{
+    tx0 = (int)floorf((L.position.x - L.range - gDynamic.minX) / tileSize) - 1;
+    tx1 = (int)floorf((L.position.x + L.range - gDynamic.minX) / tileSize) + 1;
+    tz0 = (int)floorf((L.position.z - L.range - gDynamic.minZ) / tileSize) - 1;
+    tz1 = (int)floorf((L.position.z + L.range - gDynamic.minZ) / tileSize) + 1;
+}
 
-    const int tx0 = std::max(0,        lx - R), tx1 = std::min(dungeonWidth-1, lx + R);
-    const int tz0 = std::max(0,        lz - R), tz1 = std::min(dungeonHeight-1, lz + R);
-
-    for (int tz = tz0; tz <= tz1; ++tz) {
-        for (int tx = tx0; tx <= tx1; ++tx) {
-            const float cx = gDynamic.minX + (tx + 0.5f)*tileSize;
-            const float cz = gDynamic.minZ + (tz + 0.5f)*tileSize;
-
-            // quick circle cull (center)
-            const float cdx = cx - lightPos.x, cdz = cz - lightPos.z;
-            if (cdx*cdx + cdz*cdz > (radius + 0.75f*tileSize)*(radius + 0.75f*tileSize)) continue;
-
-            // Decide visibility model for this tile:
-            // default: uniform vis=1 (fast path)
-            float visUniform = 1.0f;
-            float vis2x2[2][2]; bool useSubtile = false;
-
-            //if (TileNearSolid(tx, tz, dungeonImg)) { //dont do this check for better results. 
-            // compute 2×2 sub-tile vis only near occluders
-            SubtileVis2x2(vis2x2, lightPos, cx, cz, tileSize, floorHeight);
-            // if all zero, skip whole tile
-            if (vis2x2[0][0]==0 && vis2x2[0][1]==0 && vis2x2[1][0]==0 && vis2x2[1][1]==0) continue;
-            useSubtile = true;
-            //}
-
-            // Texel bounds for this tile
-            const int x0 = tx*tppX, x1 = x0 + tppX - 1;
-            const int y0 = tz*tppZ, y1 = y0 + tppZ - 1;
-
-            for (int y = y0; y <= y1; ++y) {
-                const float texV = (y + 0.5f)/bufH;
-                const float wz   = gDynamic.minZ + texV * gDynamic.sizeZ;
-
-                for (int x = x0; x <= x1; ++x) {
-                    const float texU = (x + 0.5f)/bufW;
-                    const float wx   = gDynamic.minX + texU * gDynamic.sizeX;
-
-                    const float dx = wx - lightPos.x, dz = wz - lightPos.z;
-                    const float d2 = dx*dx + dz*dz;
-                    if (d2 > r2) continue;
+static void BuildInfluenceLists()
+{
+    gPageLights.assign((size_t)gPagesX * gPagesZ, {});
+    gBlockLights.assign((size_t)gBlocksX * gBlocksZ, {});
 
-                    // falloff (smootherstep)
-                    const float t = 1.0f - (d2 / r2);
-                    if (t <= 0.0f) continue;
-                    float w = t*t*(3.0f - 2.0f*t);
-
-                    // apply visibility
-                    float vis = visUniform;
-                    if (useSubtile) {
-                        // map texel to sub-tile index (2×2)
-                        int sx = ((x - x0) * 2) / tppX; if (sx < 0) sx = 0; else if (sx > 1) sx = 1;
-                        int sy = ((y - y0) * 2) / tppZ; if (sy < 0) sy = 0; else if (sy > 1) sy = 1;
-                        vis = vis2x2[sy][sx];
-                        if (vis <= 0.0f) continue;
-                    }
-
-                    w *= vis;
-                    if (w <= 0.0f) continue;
-
-                    Color& p = outBuf[y*bufW + x];
-                    int r = p.r + (int)(color.r * w);
-                    int g = p.g + (int)(color.g * w);
-                    int b = p.b + (int)(color.b * w);
-                    p.r = (unsigned char)std::min(r, 255);
-                    p.g = (unsigned char)std::min(g, 255);
-                    p.b = (unsigned char)std::min(b, 255);
-                }
+    for (int i = 0; i < (int)gBakeLights.size(); ++i) {
+        int tx0, tz0, tx1, tz1;
+        LightTileRect(gBakeLights[i], tx0, tz0, tx1, tz1);
+
+        if (tx1 < 0 || tz1 < 0) continue; // entirely off the map's low side
+
+        auto add = [&](std::vector<std::vector<int>>& lists, int cols, int rows, int tilesPer) {
+            const int x0 = std::max(0, tx0 / tilesPer), x1 = std::min(cols - 1, tx1 / tilesPer);
+            const int z0 = std::max(0, tz0 / tilesPer), z1 = std::min(rows - 1, tz1 / tilesPer);
+            for (int z = z0; z <= z1; ++z) {
+                for (int x = x0; x <= x1; ++x) lists[(size_t)z * cols + x].push_back(i);
             }
-        }
+        };
+        add(gPageLights, gPagesX, gPagesZ, kLightmapPageTiles);
+        add(gBlockLights, gBlocksX, gBlocksZ, kBakeBlockTiles);
+    }
+}
+
+// --- Occluders that change at runtime: closed doors and intact barrels on top of the PVS walls ---
+static void MarkOccluderBox(std::vector<uint8_t>& cells, const PVSOccluderGrid& g, const BoundingBox& b)
+{
+    const float cell = tileSize / g.cellsPerTile;
+    const int x0 = std::max(0, (int)floorf(b.min.x / cell)), x1 = std::min(g.w - 1, (int)floorf(b.max.x / cell));
+    const int z0 = std::max(0, (int)floorf(b.min.z / cell)), z1 = std::min(g.h - 1, (int)floorf(b.max.z / cell));
+    for (int z = z0; z <= z1; ++z) {
+        for (int x = x0; x <= x1; ++x) cells[(size_t)z * g.w + x] = 1;
     }
 }
 
+// Copy of the wall grid with whatever blocks right now rasterized in. The returned grid points into cells.
+static PVSOccluderGrid SnapshotBakeOccluders(std::vector<uint8_t>& cells)
+{
+    PVSOccluderGrid g = GetPVSOccluderGrid();
+    if (!g.cells) return g;
+
+    cells.assign(g.cells, g.cells + (size_t)g.w * g.h);
+    for (const Door& d : doors) if (!d.isOpen) MarkOccluderBox(cells, g, d.collider);
+    for (const BarrelInstance& b : barrelInstances) if (!b.destroyed) MarkOccluderBox(cells, g, b.bounds);
+    g.cells = cells.data();
+    return g;
+}
+
+static uint64_t HashOccluderState(uint64_t seed)
+{
+    std::vector<uint8_t> state;
+    state.reserve(doors.size() + barrelInstances.size());
+    for (const Door& d : doors) state.push_back(d.isOpen ? 1 : 0);
+    for (const BarrelInstance& b : barrelInstances) state.push_back(b.destroyed ? 1 : 0);
+    return HashBytes(state.data(), state.size(), seed);
+}
+
 
 
 // Compute world-space bounds from dungeon indices & tile size.
@@ -277,34 +484,314 @@ static void ComputeDungeonXZBounds(int dungeonWidth, int dungeonHeight, float ti
     outSizeZ = (maxZ - minZ);
 }
 
-void InitDynamicLightmap(int res)
+static void UnloadLightmapTextures()
 {
-    gStaticBase.clear();
-    // If re-initting, free the old GPU texture to avoid leaks
-    if (gDynamic.tex.id != 0){
-        UnloadTexture(gDynamic.tex);
-    } 
-
-    // Resolution
-    gDynamic.w = res;
-    gDynamic.h = res;
+    if (gOverviewTex.id != 0) UnloadTexture(gOverviewTex);
+    if (gPageAtlas.id != 0) UnloadTexture(gPageAtlas);
+    if (gPageTableTex.id != 0) UnloadTexture(gPageTableTex);
+    gOverviewTex = gPageAtlas = gPageTableTex = {0, 0, 0, 0, 0};
+}
 
-    gStaticBase.assign((size_t)gDynamic.w * gDynamic.h, (Color){0,0,0,255});
+void InitDynamicLightmap(int texelsPerTile)
+{
+    CancelLightRebake();
+
+    // If re-initting, free the old GPU textures to avoid leaks
+    UnloadLightmapTextures();
+    gBaked = false;
+    gBakeLights.clear();
+    gBakeColors.clear();
+    gBakeFields.clear();
+
+    gTexelsPerTile = std::max(1, texelsPerTile);
+    gPageTexels = kLightmapPageTiles * gTexelsPerTile;
+    gSlotTexels = gPageTexels + 2;
+    gPagesX = (dungeonWidth  + kLightmapPageTiles - 1) / kLightmapPageTiles;
+    gPagesZ = (dungeonHeight + kLightmapPageTiles - 1) / kLightmapPageTiles;
+    gBlocksX = (dungeonWidth  + kBakeBlockTiles - 1) / kBakeBlockTiles;
+    gBlocksZ = (dungeonHeight + kBakeBlockTiles - 1) / kBakeBlockTiles;
 
     // World-space mapping for this level (XZ bounds)
     ComputeDungeonXZBounds(dungeonWidth, dungeonHeight, tileSize, floorHeight,
                            gDynamic.minX, gDynamic.minZ, gDynamic.sizeX, gDynamic.sizeZ);
 
-    // CPU buffer (black = no light)
-    gDynamic.pixels.assign(gDynamic.w * gDynamic.h, (Color){0,0,0,255});
-
-    // GPU texture
-    Image img = GenImageColor(gDynamic.w, gDynamic.h, BLACK);
-    gDynamic.tex = LoadTextureFromImage(img);
-    UnloadImage(img);
+    // gDynamic is the overview: one texel per tile, filled by BuildStaticLightmapOnce
+    gDynamic.w = std::max(1, dungeonWidth);
+    gDynamic.h = std::max(1, dungeonHeight);
+    gDynamic.pixels.clear();
+    gOverview.assign((size_t)gDynamic.w * gDynamic.h * 4, 0);
 
+    Image img = { gOverview.data(), gDynamic.w, gDynamic.h, 1, PIXELFORMAT_UNCOMPRESSED_R16G16B16A16 };
+    gOverviewTex = LoadTextureFromImage(img); // copies
+    gDynamic.tex = gOverviewTex;
     SetTextureFilter(gDynamic.tex, TEXTURE_FILTER_BILINEAR);
     SetTextureWrap(gDynamic.tex, TEXTURE_WRAP_CLAMP);
+
+    // page atlas starts empty, pages stream in once the bake inputs are known
+    const int atlasSize = kAtlasSlotsPerRow * gSlotTexels;
+    std::vector<uint16_t> zeros((size_t)atlasSize * atlasSize * 4, 0);
+    Image atlasImg = { zeros.data(), atlasSize, atlasSize, 1, PIXELFORMAT_UNCOMPRESSED_R16G16B16A16 };
+    gPageAtlas = LoadTextureFromImage(atlasImg);
+    SetTextureFilter(gPageAtlas, TEXTURE_FILTER_BILINEAR);
+    SetTextureWrap(gPageAtlas, TEXTURE_WRAP_CLAMP);
+
+    gPageTable.assign((size_t)std::max(1, gPagesX * gPagesZ), -1.0f);
+    gSlotPage.assign((size_t)kAtlasSlotsPerRow * kAtlasSlotsPerRow, -1);
+    Image tableImg = { gPageTable.data(), std::max(1, gPagesX), std::max(1, gPagesZ), 1, PIXELFORMAT_UNCOMPRESSED_R32 };
+    gPageTableTex = LoadTextureFromImage(tableImg);
+    SetTextureFilter(gPageTableTex, TEXTURE_FILTER_POINT); // read with texelFetch anyway
+    SetTextureWrap(gPageTableTex, TEXTURE_WRAP_CLAMP);
+
+    InitLightClusters(gDynamic.minX, gDynamic.minZ, gDynamic.sizeX, gDynamic.sizeZ);
+}
+
+void SetLightmapPageShaderValues(Shader shader)
+{
+    int locAtlas = GetShaderLocation(shader, "lightPageAtlas");
+    int locTable = GetShaderLocation(shader, "lightPageTable");
+    int locInfo  = GetShaderLocation(shader, "pageInfo");
+    int locGrid  = GetShaderLocation(shader, "pageGrid");
+
+    float info[4] = { kLightmapPageTiles * tileSize, (float)gPageTexels, (float)gSlotTexels, 0.0f };
+    int grid[4] = { gPagesX, gPagesZ, kAtlasSlotsPerRow, kAtlasSlotsPerRow * gSlotTexels };
+
+    if (locInfo >= 0) SetShaderValue(shader, locInfo, info, SHADER_UNIFORM_VEC4);
+    if (locGrid >= 0) SetShaderValue(shader, locGrid, grid, SHADER_UNIFORM_IVEC4);
+    if (locAtlas >= 0 && gPageAtlas.id != 0) SetShaderValueTexture(shader, locAtlas, gPageAtlas);
+    if (locTable >= 0 && gPageTableTex.id != 0) SetShaderValueTexture(shader, locTable, gPageTableTex);
+}
+
+// --- Incremental rebake when a door opens or a barrel breaks ---
+// Only lights whose square overlaps the change get a new visibility field, and only the resident pages
+// and overview blocks those lights reach get baked again. A region is baked whole from its light list,
+// the saturating stamps can't be subtracted back out. Runs on its own thread (the job pool is main
+// thread only). The results are the back buffer: nothing is uploaded until the whole rebake is done,
+// then every region swaps in on the same frame, so the light never shows half updated.
+struct LightRebake {
+    uint64_t inputsHash = 0;
+    std::vector<uint8_t> occluderCells;
+    PVSOccluderGrid occluders;
+    LightFieldTable fieldTable;             // gBakeFieldTable with the changed lights pointing at fields below
+    std::vector<int> lights;                // lights whose visibility changed
+    std::vector<LightVisField> fields;      // their new fields, same order
+    std::vector<int> pages, blocks;
+    std::vector<std::vector<uint16_t>> pageData, blockData;
+};
+
+struct RebakeThread {
+    std::thread t;
+    ~RebakeThread() { if (t.joinable()) t.join(); }
+};
+
+static std::unique_ptr<LightRebake> gRebake;  // in flight, the thread owns it until gRebakeDone
+static RebakeThread gRebakeThread;
+static std::atomic<bool> gRebakeDone{false};
+static std::vector<BoundingBox> gRebakePending; // changes waiting for the next rebake
+static std::vector<int> gRebakeStalePages;      // pages streamed in while a rebake ran
+
+static void RunLightRebake(LightRebake& job)
+{
+    for (size_t k = 0; k < job.lights.size(); ++k) {
+        const LightSource& L = gBakeLights[job.lights[k]];
+        BuildLightVisField(job.fields[k], job.occluders, L.position, L.range);
+        job.fieldTable[job.lights[k]] = &job.fields[k];
+    }
+    for (size_t i = 0; i < job.pages.size(); ++i) {
+        BakeRegion(PageRegion(job.pages[i]), gPageLights[job.pages[i]], job.fieldTable, job.pageData[i]);
+    }
+    for (size_t i = 0; i < job.blocks.size(); ++i) {
+        BakeRegion(BlockRegion(job.blocks[i]), gBlockLights[job.blocks[i]], job.fieldTable, job.blockData[i]);
+    }
+}
+
+static bool ListsAny(const std::vector<int>& list, const std::vector<char>& flags)
+{
+    for (int i : list) if (flags[i]) return true;
+    return false;
+}
+
+static void LaunchLightRebake()
+{
+    auto job = std::make_unique<LightRebake>();
+    job->occluders = SnapshotBakeOccluders(job->occluderCells);
+    job->inputsHash = HashOccluderState(gBakeBaseHash);
+
+    // lights whose square touches a change, the rest can't see it. A tile of slack covers the
+    // field's margin and sampling ring past the radius.
+    std::vector<char> changed(gBakeLights.size(), 0);
+    for (int i = 0; i < (int)gBakeLights.size(); ++i) {
+        const LightSource& L = gBakeLights[i];
+        const float reach = L.range + tileSize;
+        for (const BoundingBox& b : gRebakePending) {
+            if (L.position.x + reach < b.min.x || L.position.x - reach > b.max.x) continue;
+            if (L.position.z + reach < b.min.z || L.position.z - reach > b.max.z) continue;
+            changed[i] = 1;
+            job->lights.push_back(i);
+            break;
+        }
+    }
+    gRebakePending.clear();
+
+    if (job->lights.empty()) { // nothing lit there, only the cache key moves
+        gBakeInputsHash = job->inputsHash;
+        return;
+    }
+
+    for (int p = 0; p < (int)gPageTable.size(); ++p) {
+        if (gPageTable[p] >= 0.0f && ListsAny(gPageLights[p], changed)) job->pages.push_back(p);
+    }
+    for (int b = 0; b < (int)gBlockLights.size(); ++b) {
+        if (ListsAny(gBlockLights[b], changed)) job->blocks.push_back(b);
+    }
+    job->fieldTable = gBakeFieldTable;
+    job->fields.resize(job->lights.size());
+    job->pageData.resize(job->pages.size());
+    job->blockData.resize(job->blocks.size());
+
+    gRebakeStalePages.clear();
+    gRebakeDone = false;
+    gRebake = std::move(job);
+    LightRebake* raw = gRebake.get();
+    gRebakeThread.t = std::thread([raw]() {
+        RunLightRebake(*raw);
+        gRebakeDone = true;
+    });
+}
+
+static void ApplyLightRebake(LightRebake& job)
+{
+    // new fields in, gBakeFieldTable already points at these slots
+    for (size_t k = 0; k < job.lights.size(); ++k) gBakeFields[job.lights[k]] = std::move(job.fields[k]);
+    gBakeInputsHash = job.inputsHash;
+
+    std::vector<char> changed(gBakeLights.size(), 0);
+    for (int i : job.lights) changed[i] = 1;
+
+    // pages that streamed in meanwhile used the old fields, drop them so they stream again
+    bool tableDirty = false;
+    for (int p : gRebakeStalePages) {
+        const int slot = (int)gPageTable[p];
+        if (slot < 0 || !ListsAny(gPageLights[p], changed)) continue;
+        gPageTable[p] = -1.0f;
+        gSlotPage[slot] = -1;
+        tableDirty = true;
+    }
+
+    for (size_t i = 0; i < job.pages.size(); ++i) {
+        const int p = job.pages[i];
+        const int slot = (int)gPageTable[p];
+        if (slot < 0 || std::find(gRebakeStalePages.begin(), gRebakeStalePages.end(), p) != gRebakeStalePages.end()) continue;
+        Rectangle rec = { (float)((slot % kAtlasSlotsPerRow) * gSlotTexels),
+                          (float)((slot / kAtlasSlotsPerRow) * gSlotTexels),
+                          (float)gSlotTexels, (float)gSlotTexels };
+        UpdateTextureRec(gPageAtlas, rec, job.pageData[i].data());
+    }
+    if (tableDirty) UpdateTexture(gPageTableTex, gPageTable.data());
+
+    for (size_t i = 0; i < job.blocks.size(); ++i) {
+        const LightmapRegion reg = BlockRegion(job.blocks[i]);
+        for (int y = 0; y < reg.h; ++y) {
+            std::copy_n(&job.blockData[i][(size_t)y * reg.w * 4], (size_t)reg.w * 4,
+                        &gOverview[((size_t)(reg.z0 + y) * gDynamic.w + reg.x0) * 4]);
+        }
+    }
+    if (!job.blocks.empty() && gOverviewTex.id != 0) UpdateTexture(gOverviewTex, gOverview.data());
+
+    gRebakeStalePages.clear();
+}
+
+// Finish (and apply) a rebake that's done, then start the next one if changes queued up.
+static void PumpLightRebake()
+{
+    if (gRebake) {
+        if (!gRebakeDone) return;
+        gRebakeThread.t.join();
+        ApplyLightRebake(*gRebake);
+        gRebake.reset();
+    }
+    if (gBaked && !gRebakePending.empty()) LaunchLightRebake();
+}
+
+void RebakeLightsAround(const BoundingBox& changed)
+{
+    if (!gBaked) return;
+    gRebakePending.push_back(changed);
+    PumpLightRebake();
+}
+
+void CancelLightRebake()
+{
+    if (gRebakeThread.t.joinable()) gRebakeThread.t.join();
+    gRebake.reset();
+    gRebakePending.clear();
+    gRebakeStalePages.clear();
+}
+
+// Makes the pages around center resident, nearest first, at most maxBakes per call. Pages that fell
+// out of range keep their slot until a wanted page needs it.
+static void StreamLightmapPages(const Vector3& center, int maxBakes)
+{
+    if (!gBaked || gPagesX <= 0 || gPagesZ <= 0) return;
+
+    const float pageWorld = kLightmapPageTiles * tileSize;
+    const int cpx = std::clamp((int)floorf((center.x - gDynamic.minX) / pageWorld), 0, gPagesX - 1);
+    const int cpz = std::clamp((int)floorf((center.z - gDynamic.minZ) / pageWorld), 0, gPagesZ - 1);
+    auto pageDist = [&](int page) {
+        return std::max(std::abs(page % gPagesX - cpx), std::abs(page / gPagesX - cpz));
+    };
+
+    std::vector<int> toLoad;
+    for (int d = 0; d <= kPageResidentRadius && (int)toLoad.size() < maxBakes; ++d) {
+        for (int pz = cpz - d; pz <= cpz + d; ++pz) {
+            for (int px = cpx - d; px <= cpx + d; ++px) {
+                if (std::max(std::abs(px - cpx), std::abs(pz - cpz)) != d) continue; // ring d only
+                if (px < 0 || pz < 0 || px >= gPagesX || pz >= gPagesZ) continue;
+                const int page = pz * gPagesX + px;
+                if (gPageTable[page] < 0.0f && (int)toLoad.size() < maxBakes) toLoad.push_back(page);
+            }
+        }
+    }
+    if (toLoad.empty()) return;
+
+    // slots: free ones first, then the farthest page nobody wants any more
+    std::vector<int> slots(toLoad.size(), -1);
+    for (size_t i = 0; i < toLoad.size(); ++i) {
+        int best = -1, bestDist = kPageResidentRadius;
+        for (int s = 0; s < (int)gSlotPage.size(); ++s) {
+            if (gSlotPage[s] < 0) { best = s; break; }
+            const int d = pageDist(gSlotPage[s]);
+            if (d > bestDist) { best = s; bestDist = d; }
+        }
+        if (best < 0) break; // can't happen, see the static_assert
+        if (gSlotPage[best] >= 0) gPageTable[gSlotPage[best]] = -1.0f;
+        gSlotPage[best] = toLoad[i];
+        slots[i] = best;
+    }
+
+    std::vector<std::vector<uint16_t>> data(toLoad.size());
+    EnsureLightmapCacheDir(); // here, the workers only read and write files in it
+    JobPool::Get().ParallelFor(toLoad.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (slots[i] >= 0) LoadOrBakeRegion(PageRegion(toLoad[i]), gPageLights[toLoad[i]], data[i]);
+        }
+    });
+
+    for (size_t i = 0; i < toLoad.size(); ++i) {
+        if (slots[i] < 0) continue;
+        Rectangle rec = { (float)((slots[i] % kAtlasSlotsPerRow) * gSlotTexels),
+                          (float)((slots[i] / kAtlasSlotsPerRow) * gSlotTexels),
+                          (float)gSlotTexels, (float)gSlotTexels };
+        UpdateTextureRec(gPageAtlas, rec, data[i].data());
+        gPageTable[toLoad[i]] = (float)slots[i];
+        if (gRebake) gRebakeStalePages.push_back(toLoad[i]); // baked with the fields the rebake is replacing
+    }
+    UpdateTexture(gPageTableTex, gPageTable.data());
+}
+
+void UpdateLightmapPages(const Vector3& center)
+{
+    PumpLightRebake();
+    StreamLightmapPages(center, kMaxPageBakesPerFrame);
 }
 
 
@@ -336,131 +823,115 @@ XZBounds ComputeXZFromTiles(const std::vector<FloorTile>& tiles, float tileSize)
 
 
 
-static void StampDynamicLight(const Vector3& lightPos, float radius, Color color) {
-    // Map world XZ -> texture space //used for fireballs and player light, No occlusion
-    float u = (lightPos.x - gDynamic.minX) / gDynamic.sizeX; // 0..1
-    float v = (lightPos.z - gDynamic.minZ) / gDynamic.sizeZ; // 0..1
-
-    int cx = (int)(u * gDynamic.w);
-    int cy = (int)(v * gDynamic.h);
-
-    int rx = (int)ceilf((radius / gDynamic.sizeX) * gDynamic.w);
-    int ry = (int)ceilf((radius / gDynamic.sizeZ) * gDynamic.h);
-
-    int x0 = std::max(0, cx - rx), x1 = std::min(gDynamic.w - 1, cx + rx);
-    int y0 = std::max(0, cy - ry), y1 = std::min(gDynamic.h - 1, cy + ry);
-
-    for (int y = y0; y <= y1; ++y) {
-        for (int x = x0; x <= x1; ++x) {
-            float texU = (x + 0.5f) / gDynamic.w;
-            float texV = (y + 0.5f) / gDynamic.h;
-            float wx = gDynamic.minX + texU * gDynamic.sizeX;
-            float wz = gDynamic.minZ + texV * gDynamic.sizeZ;
-
-            float dx = wx - lightPos.x;
-            float dz = wz - lightPos.z;
-            float d  = sqrtf(dx*dx + dz*dz);
-
-            float w = SmoothFalloff(d, radius);
-            if (w <= 0.0f) continue;
-
-            Color& p = gDynamic.pixels[y * gDynamic.w + x];
-
-            // Additive (clamped); dynamic map stores 0..255 color
-            int r = p.r + (int)(color.r * w);
-            int g = p.g + (int)(color.g * w);
-            int b = p.b + (int)(color.b * w);
-            p.r = (unsigned char)std::min(r, 255);
-            p.g = (unsigned char)std::min(g, 255);
-            p.b = (unsigned char)std::min(b, 255);
-            // alpha unused; keep 255
-        }
-    }
-}
-
-
-static size_t CountNonBlack(const std::vector<Color>& buf) {
+static size_t CountNonBlack(const std::vector<uint16_t>& rgbaHalf) {
     size_t n = 0;
-    for (const Color& c : buf) if ( (c.r | c.g | c.b) != 0 ) ++n;
+    for (size_t i = 0; i + 3 < rgbaHalf.size(); i += 4) {
+        if ((rgbaHalf[i] | rgbaHalf[i + 1] | rgbaHalf[i + 2]) != 0) ++n;
+    }
     return n;
 }
 
-// Call this right before/after UpdateTexture(...)
+// Call this right before/after UpdateTexture(...). Counts the overview, pages come and go.
 void LogDynamicLightmapNonBlack(const char* tag) {
-    size_t nb = CountNonBlack(gDynamic.pixels);
-    TraceLog(LOG_INFO, "[%s] nonBlack=%zu / %zu  texID=%d  res=%dx%d  bounds={minX=%.2f minZ=%.2f sizeX=%.2f sizeZ=%.2f}",
-             tag, nb, gDynamic.pixels.size(),
-             gDynamic.tex.id, gDynamic.w, gDynamic.h,
+    size_t nb = CountNonBlack(gOverview);
+    TraceLog(LOG_INFO, "[%s] nonBlack=%zu / %zu  texID=%d  res=%dx%d  pages=%dx%d@%dtpt  bounds={minX=%.2f minZ=%.2f sizeX=%.2f sizeZ=%.2f}",
+             tag, nb, gOverview.size() / 4,
+             gDynamic.tex.id, gDynamic.w, gDynamic.h, gPagesX, gPagesZ, gTexelsPerTile,
              gDynamic.minX, gDynamic.minZ, gDynamic.sizeX, gDynamic.sizeZ);
 }
 
 void BuildStaticLightmapOnce(const std::vector<LightSource>& dungeonLights)
 {
-    gStaticBase.assign((size_t)gDynamic.w * gDynamic.h, (Color){0,0,0,255});
+    CancelLightRebake();
+    gBaked = false;
+    if (dungeonWidth <= 0 || dungeonHeight <= 0) return;
+
+    TrimLightmapCache(); // once a level, before any page job reads it
+    gBakeLights = dungeonLights;
+    gBakeBaseHash = HashStaticBakeInputs(dungeonLights);
+    gBakeInputsHash = HashOccluderState(gBakeBaseHash);
+    BuildInfluenceLists();
+
+    gBakeColors.clear();
+    gBakeColors.reserve(dungeonLights.size());
     for (const auto& L : dungeonLights) {
-        Color c = {
+        gBakeColors.push_back({
             (unsigned char)Clamp(L.colorTint.x * 255.0f * L.intensity, 0.0f, 255.0f),
             (unsigned char)Clamp(L.colorTint.y * 255.0f * L.intensity, 0.0f, 255.0f),
             (unsigned char)Clamp(L.colorTint.z * 255.0f * L.intensity, 0.0f, 255.0f),
             255
-        };
+        });
+    }
 
-        StampLight_StaticBase_Subtile2x2_ToBuffer(gStaticBase, gDynamic.w, gDynamic.h, L.position, L.range, c);
+    // one visibility field per light, every region bake reads them. Kept for pages baked later.
+    // Closed doors and barrels block too, RebakeLightsAround catches up when they stop.
+    std::vector<uint8_t> occluderCells;
+    const PVSOccluderGrid occluders = SnapshotBakeOccluders(occluderCells);
+    gBakeFields.assign(dungeonLights.size(), LightVisField{});
+    gBakeFieldTable.resize(dungeonLights.size());
+    JobPool::Get().ParallelFor(dungeonLights.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            BuildLightVisField(gBakeFields[i], occluders, dungeonLights[i].position, dungeonLights[i].range);
+            gBakeFieldTable[i] = &gBakeFields[i];
+        }
+    });
+
+    // Overview: whole map at one texel per tile. Same map + same lights baked before? load it instead.
+    LightmapRegion overview;
+    overview.w = dungeonWidth;
+    overview.h = dungeonHeight;
+    const uint64_t cacheKey = RegionCacheKey(overview);
+    if (LoadLightmapCache(cacheKey, overview.w, overview.h, gOverview)) {
+        TraceLog(LOG_INFO, "[lightmap] overview loaded from cache (%016llx)", (unsigned long long)cacheKey);
+    } else {
+        // Bake in square tile blocks on the job pool. Every block owns its texels outright, so jobs
+        // write straight into the accumulator with no merge step. Stamps are saturating adds of
+        // non-negative values, same result in any order, so the output doesn't depend on scheduling.
+        LightAccum16 acc;
+        acc.Reset(overview.w, overview.h);
+        JobPool::Get().ParallelFor((size_t)(gBlocksX * gBlocksZ), 1, [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                const LightmapRegion block = BlockRegion((int)b);
+                StampBakeLights(acc, overview, gBlockLights[b], gBakeFieldTable, block.x0, block.z0,
+                                block.x0 + block.w - 1, block.z0 + block.h - 1);
+            }
+        });
 
+        ResolveRegion(acc, overview, gOverview);
+        EnsureLightmapCacheDir();
+        SaveLightmapCache(cacheKey, overview.w, overview.h, gOverview);
     }
 
-    // headroom so fireballs add nicely:
-    for (Color& p : gStaticBase) {
-        p.r = (unsigned char)(p.r * 0.65f);
-        p.g = (unsigned char)(p.g * 0.65f);
-        p.b = (unsigned char)(p.b * 0.65f);
-    }
+    // overview only changes here, upload it once
+    if (gOverviewTex.id != 0) UpdateTexture(gOverviewTex, gOverview.data());
 
-    BuildLavaMaskAlphaFromImage(dungeonImg);
-        
+    // fresh bake, every page is stale
+    std::fill(gPageTable.begin(), gPageTable.end(), -1.0f);
+    std::fill(gSlotPage.begin(), gSlotPage.end(), -1);
+    gBaked = true;
+
+    // everything around the player now, no waiting on the per-frame budget
+    StreamLightmapPages(player.position, (2 * kPageResidentRadius + 1) * (2 * kPageResidentRadius + 1));
 }
 
-void BuildDynamicLightmapFromFrameLights(const std::vector<LightSample>& frameLights)
+void UploadFrameLights(const std::vector<LightSample>& frameLights)
 {
-    // Start from the static base. Copy the static light values every frame.
-    gDynamic.pixels = gStaticBase;
+    static std::vector<LightSample> lights; // reused, no per-frame allocation
+    lights.clear();
 
-    //Dynamic player light
-    const LightSample ls =  {
+    //Dynamic player light, always index 0 so it never gets dropped
+    lights.push_back({
         player.position,
         Vector3 {1.0f, 1.0f, 1.0f},  //white
         player.lightRange,
         player.lightIntensity,
-    };
-
-    Color c = {
-        (unsigned char)Clamp(ls.color.x * 255.0f * ls.intensity, 0.0f, 255.0f),
-        (unsigned char)Clamp(ls.color.y * 255.0f * ls.intensity, 0.0f, 255.0f),
-        (unsigned char)Clamp(ls.color.z * 255.0f * ls.intensity, 0.0f, 255.0f),
-        255
-    };
-
-    //stamp player light. 
-    StampDynamicLight(ls.pos, ls.range, c);
+    });
 
-
-
-    // Stamp dynamic movers (fireballs).
+    // dynamic movers (fireballs). No occlusion, too expensive, but lights that can't reach a room
+    // the camera sees into are dropped before they take up cluster slots.
     for (const LightSample& L : frameLights) {
-        Color c = {
-            (unsigned char)Clamp(L.color.x * 255.0f * L.intensity, 0.0f, 255.0f),
-            (unsigned char)Clamp(L.color.y * 255.0f * L.intensity, 0.0f, 255.0f),
-            (unsigned char)Clamp(L.color.z * 255.0f * L.intensity, 0.0f, 255.0f),
-            255
-        };
-        StampDynamicLight(L.pos, L.range, c);
-        // No occlusion for fireballs, too expensive. 
+        if (RoomsInView(L.pos, L.range)) lights.push_back(L);
     }
 
-    UpdateTexture(gDynamic.tex, gDynamic.pixels.data());
-
+    BuildLightClusters(lights);
 }
-
-
-
-
@@ -0,0 +1,138 @@
+#include "render/lightmapCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+#include "raylib.h"
+
+static const char* kCacheDir = "cache/lightmaps";
+static const uint32_t kCacheMagic = 0x434D4C4D; // "MLMC"
+static const uint32_t kCacheVersion = 2; // 2: RGBA16F texels
+static const uintmax_t kCacheMaxBytes = 256ull * 1024 * 1024;
+
+// File = header + compressed RGBA half-float texels
+struct LightmapCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    int32_t  w, h;
+    uint32_t rawSize;
+    uint32_t reserved; // keeps the struct padding-free
+};
+
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// own buffer, not TextFormat's: page loads run on job pool workers while the main thread formats text
+struct CachePathBuf { char str[64]; };
+
+static CachePathBuf CachePath(uint64_t key) {
+    CachePathBuf path;
+    snprintf(path.str, sizeof(path.str), "%s/%016llx.lmc", kCacheDir, (unsigned long long)key);
+    return path;
+}
+
+bool EnsureLightmapCacheDir() {
+    if (DirectoryExists(kCacheDir)) return true;
+    if (MakeDirectory(kCacheDir) == 0) return true;
+    TraceLog(LOG_WARNING, "lightmap cache: can't create %s", kCacheDir);
+    return false;
+}
+
+static const size_t kTexelBytes = 4 * sizeof(uint16_t);
+
+bool LoadLightmapCache(uint64_t key, int w, int h, std::vector<uint16_t>& out) {
+    const CachePathBuf pathBuf = CachePath(key);
+    const char* path = pathBuf.str;
+    if (!FileExists(path)) return false;
+
+    int fileSize = 0;
+    unsigned char* file = LoadFileData(path, &fileSize);
+    if (!file) return false;
+
+    bool ok = false;
+    LightmapCacheHeader hdr;
+    const size_t expected = (size_t)w * h * kTexelBytes;
+
+    if ((size_t)fileSize > sizeof(hdr)) {
+        std::memcpy(&hdr, file, sizeof(hdr));
+        ok = hdr.magic == kCacheMagic && hdr.version == kCacheVersion && hdr.key == key
+          && hdr.w == w && hdr.h == h && hdr.rawSize == expected;
+    }
+
+    if (ok) {
+        int rawSize = 0;
+        unsigned char* raw = DecompressData(file + sizeof(hdr), fileSize - (int)sizeof(hdr), &rawSize);
+        ok = raw && (size_t)rawSize == expected;
+        if (ok) {
+            out.resize((size_t)w * h * 4);
+            std::memcpy(out.data(), raw, expected);
+        }
+        if (raw) MemFree(raw);
+    }
+
+    UnloadFileData(file);
+    if (!ok) TraceLog(LOG_WARNING, "lightmap cache: ignoring stale or damaged %s", path);
+
+    // mtime is the last use for TrimLightmapCache
+    std::error_code ec;
+    if (ok) std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+    return ok;
+}
+
+void SaveLightmapCache(uint64_t key, int w, int h, const std::vector<uint16_t>& rgbaHalf) {
+    const size_t rawSize = (size_t)w * h * kTexelBytes;
+    if (rgbaHalf.size() * sizeof(uint16_t) != rawSize || rawSize == 0) return;
+
+    int compSize = 0;
+    unsigned char* comp = CompressData((const unsigned char*)rgbaHalf.data(), (int)rawSize, &compSize);
+    if (!comp) return;
+
+    LightmapCacheHeader hdr = { kCacheMagic, kCacheVersion, key, w, h, (uint32_t)rawSize, 0 };
+    std::vector<unsigned char> file(sizeof(hdr) + (size_t)compSize);
+    std::memcpy(file.data(), &hdr, sizeof(hdr));
+    std::memcpy(file.data() + sizeof(hdr), comp, (size_t)compSize);
+    MemFree(comp);
+
+    SaveFileData(CachePath(key).str, file.data(), (int)file.size());
+}
+
+void TrimLightmapCache() {
+    namespace fs = std::filesystem;
+    struct Entry {
+        fs::path path;
+        fs::file_time_type used;
+        uintmax_t size;
+    };
+
+    std::error_code ec;
+    std::vector<Entry> entries;
+    uintmax_t total = 0;
+    for (fs::directory_iterator it(kCacheDir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->path().extension() != ".lmc") continue;
+        std::error_code timeEc, sizeEc;
+        Entry e = { it->path(), it->last_write_time(timeEc), it->file_size(sizeEc) };
+        if (timeEc || sizeEc) continue;
+        entries.push_back(e);
+        total += e.size;
+    }
+    if (total <= kCacheMaxBytes) return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+    size_t removed = 0;
+    for (const Entry& e : entries) {
+        if (total <= kCacheMaxBytes) break;
+        if (fs::remove(e.path, ec)) { total -= e.size; removed++; }
+    }
+    TraceLog(LOG_INFO, "lightmap cache: removed %zu old files, %llu bytes left", removed, (unsigned long long)total);
+}
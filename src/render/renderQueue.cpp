@@ -0,0 +1,184 @@
+#include "render/renderQueue.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "raymath.h"
+#include "rlgl.h"
+
+static const int kMaxMaterialMaps = 12;      // raylib's MAX_MATERIAL_MAPS (config.h, not exported)
+static const float kMaxSortDepth = 50000.0f; // overworld far clip, anything beyond shares the last bucket
+
+struct RenderItem {
+    Mesh mesh;
+    Material material;
+    Matrix transform;
+    Color tint;
+    Vector3 sortCenter;
+    RenderPass pass;
+    uint16_t materialIndex; // dense id per distinct maps array, for the key
+};
+
+struct SortEntry {
+    uint64_t key;
+    uint32_t item;
+};
+
+static std::vector<RenderItem> gItems;
+static std::vector<SortEntry> gSorted;
+static std::unordered_map<const MaterialMap*, uint16_t> gMaterialIds;
+
+void RenderQueuePush(const Mesh& mesh, const Material& material, const Matrix& transform, Color tint,
+                     Vector3 sortCenter, RenderPass pass) {
+    auto it = gMaterialIds.find(material.maps);
+    if (it == gMaterialIds.end()) it = gMaterialIds.emplace(material.maps, (uint16_t)gMaterialIds.size()).first;
+
+    gItems.push_back({ mesh, material, transform, tint, sortCenter, pass, it->second });
+}
+
+void RenderQueuePushModel(const Model& model, Vector3 position, Vector3 rotationAxis, float rotationAngle,
+                          Vector3 scale, Color tint) {
+    // same order as DrawModelEx: model.transform * scale * rotation * translation
+    Matrix matScale = MatrixScale(scale.x, scale.y, scale.z);
+    Matrix matRotation = MatrixRotate(rotationAxis, rotationAngle * DEG2RAD);
+    Matrix matTranslation = MatrixTranslate(position.x, position.y, position.z);
+    Matrix transform = MatrixMultiply(model.transform, MatrixMultiply(MatrixMultiply(matScale, matRotation), matTranslation));
+
+    for (int i = 0; i < model.meshCount; ++i) {
+        RenderQueuePush(model.meshes[i], model.materials[model.meshMaterial[i]], transform, tint, position);
+    }
+}
+
+static uint64_t SortKey(const RenderItem& item, Vector3 cameraPos) {
+    const float dist = Vector3Distance(cameraPos, item.sortCenter);
+    const uint64_t depth = (uint64_t)(std::min(dist / kMaxSortDepth, 1.0f) * 0xFFFFFF);
+
+    return ((uint64_t)(item.pass & 0x3) << 62)
+         | ((uint64_t)(item.material.shader.id & 0xFFF) << 50)
+         | ((uint64_t)item.materialIndex << 34)
+         | (depth << 10);
+}
+
+static void BindShader(const Shader& shader, const Matrix& matView, const Matrix& matProjection) {
+    rlEnableShader(shader.id);
+    if (shader.locs[SHADER_LOC_MATRIX_VIEW] != -1) rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_VIEW], matView);
+    if (shader.locs[SHADER_LOC_MATRIX_PROJECTION] != -1) rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_PROJECTION], matProjection);
+}
+
+// returns a mask of the texture slots it bound
+static unsigned BindMaterialMaps(const Material& material) {
+    const Shader& shader = material.shader;
+    if (shader.locs[SHADER_LOC_COLOR_SPECULAR] != -1) {
+        const Color c = material.maps[MATERIAL_MAP_SPECULAR].color;
+        const float values[4] = { c.r/255.0f, c.g/255.0f, c.b/255.0f, c.a/255.0f };
+        rlSetUniform(shader.locs[SHADER_LOC_COLOR_SPECULAR], values, SHADER_UNIFORM_VEC4, 1);
+    }
+
+    unsigned bound = 0;
+    for (int i = 0; i < kMaxMaterialMaps; ++i) {
+        const unsigned int id = material.maps[i].texture.id;
+        if (id == 0) continue;
+
+        rlActiveTextureSlot(i);
+        if (i == MATERIAL_MAP_IRRADIANCE || i == MATERIAL_MAP_PREFILTER || i == MATERIAL_MAP_CUBEMAP) rlEnableTextureCubemap(id);
+        else rlEnableTexture(id);
+        rlSetUniform(shader.locs[SHADER_LOC_MAP_DIFFUSE + i], &i, SHADER_UNIFORM_INT, 1);
+        bound |= 1u << i;
+    }
+    return bound;
+}
+
+// Only the slots a material bound, like DrawMesh. The lighting shader's lightmap, page table and cluster
+// textures sit on other units from SetShaderValueTexture once per level, clearing those would zero them.
+static void UnbindTextures(unsigned slots) {
+    for (int i = 0; i < kMaxMaterialMaps; ++i) {
+        if (!(slots & (1u << i))) continue;
+        rlActiveTextureSlot(i);
+        if (i == MATERIAL_MAP_IRRADIANCE || i == MATERIAL_MAP_PREFILTER || i == MATERIAL_MAP_CUBEMAP) rlDisableTextureCubemap();
+        else rlDisableTexture();
+    }
+    rlActiveTextureSlot(0);
+}
+
+void RenderQueueFlush(Vector3 cameraPos) {
+    if (gItems.empty()) return;
+
+    rlDrawRenderBatchActive(); // whatever rlgl has batched so far keeps its place in front of us
+
+    gSorted.resize(gItems.size());
+    for (size_t i = 0; i < gItems.size(); ++i) gSorted[i] = { SortKey(gItems[i], cameraPos), (uint32_t)i };
+    std::sort(gSorted.begin(), gSorted.end(), [](const SortEntry& a, const SortEntry& b) { return a.key < b.key; });
+
+    const Matrix matView = rlGetMatrixModelview();
+    const Matrix matProjection = rlGetMatrixProjection();
+    const Matrix matTransform = rlGetMatrixTransform();
+
+    unsigned int boundShader = 0;
+    const MaterialMap* boundMaps = nullptr;
+    bool diffuseSet = false;
+    Color boundDiffuse = {};
+    unsigned boundSlots = 0;
+
+    for (const SortEntry& entry : gSorted) {
+        const RenderItem& item = gItems[entry.item];
+        const Shader& shader = item.material.shader;
+
+        if (shader.id != boundShader) {
+            BindShader(shader, matView, matProjection);
+            boundShader = shader.id;
+            boundMaps = nullptr;
+            diffuseSet = false;
+        }
+        if (item.material.maps != boundMaps) {
+            boundSlots |= BindMaterialMaps(item.material);
+            boundMaps = item.material.maps;
+        }
+
+        // material diffuse times tint, as DrawModelEx does
+        const Color base = item.material.maps[MATERIAL_MAP_DIFFUSE].color;
+        const Color diffuse = {
+            (unsigned char)(((int)base.r * (int)item.tint.r) / 255),
+            (unsigned char)(((int)base.g * (int)item.tint.g) / 255),
+            (unsigned char)(((int)base.b * (int)item.tint.b) / 255),
+            (unsigned char)(((int)base.a * (int)item.tint.a) / 255),
+        };
+
+        if (item.mesh.vaoId == 0 || !rlEnableVertexArray(item.mesh.vaoId)) {
+            // no VAO to bind: let raylib set up the buffers itself, tinted the way DrawModelEx does it
+            MaterialMap& diffuseMap = item.material.maps[MATERIAL_MAP_DIFFUSE];
+            diffuseMap.color = diffuse;
+            DrawMesh(item.mesh, item.material, item.transform);
+            diffuseMap.color = base;
+            boundShader = 0; // DrawMesh unbinds the shader and textures
+            boundMaps = nullptr;
+            continue;
+        }
+
+        if (shader.locs[SHADER_LOC_COLOR_DIFFUSE] != -1) {
+            if (!diffuseSet || diffuse.r != boundDiffuse.r || diffuse.g != boundDiffuse.g ||
+                diffuse.b != boundDiffuse.b || diffuse.a != boundDiffuse.a) {
+                const float values[4] = { diffuse.r/255.0f, diffuse.g/255.0f, diffuse.b/255.0f, diffuse.a/255.0f };
+                rlSetUniform(shader.locs[SHADER_LOC_COLOR_DIFFUSE], values, SHADER_UNIFORM_VEC4, 1);
+                boundDiffuse = diffuse;
+                diffuseSet = true;
+            }
+        }
+
+        const Matrix matModel = MatrixMultiply(item.transform, matTransform);
+        if (shader.locs[SHADER_LOC_MATRIX_MODEL] != -1) rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_MODEL], matModel);
+        if (shader.locs[SHADER_LOC_MATRIX_NORMAL] != -1) rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_NORMAL], MatrixTranspose(MatrixInvert(matModel)));
+        rlSetUniformMatrix(shader.locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(MatrixMultiply(matModel, matView), matProjection));
+
+        if (item.mesh.indices != nullptr) rlDrawVertexArrayElements(0, item.mesh.triangleCount * 3, 0);
+        else rlDrawVertexArray(0, item.mesh.vertexCount);
+    }
+
+    UnbindTextures(boundSlots);
+    rlDisableVertexArray();
+    rlDisableVertexBuffer();
+    rlDisableVertexBufferElement();
+    rlDisableShader();
+
+    gItems.clear();
+    gMaterialIds.clear();
+}
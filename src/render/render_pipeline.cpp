@@ -1,48 +1,70 @@
 #include "render/render_pipeline.h"
 
 #include "rlgl.h"
+#include "render/dynamicResolution.h"
+#include "render/lighting.h"
+#include "render/renderQueue.h"
+#include "render/terrainChunks.h"
+#include "render/transparentDraw.h"
 #include "tools/boat.h"
 #include "util/camera_system.h"
 #include "util/resourceManager.h"
 #include "util/ui.h"
+#include "world/pvs.h"
+#include "world/rooms.h"
 #include "world/world.h"
 
 void RenderFrame(Camera3D& camera, Player& player, float dt) {
+    //the 3D scene and the fog pass run at a fraction of the window resolution that follows the frame time,
+    //bloom upscales to the window and the HUD draws at native resolution on top
+    UpdateDynamicResolution(dt);
+    ResourceManager::Get().EnsureScreenSizedRTs();
+
     BeginTextureMode(ResourceManager::Get().GetRenderTexture("sceneTexture"));
         ClearBackground(SKYBLUE);
         float farClip = isDungeon ? 10000.0f : 50000.0f;
         float nearclip = 30.0f;
         CameraSystem::Get().BeginCustom3D(camera, nearclip, farClip);
 
+        //both need the frustum from BeginCustom3D, and everything below culls against them
+        PVSBeginView(camera.position); //tiles the camera's tile can't see get skipped
+        RoomsBeginView(camera.position); //rooms not seen through an open doorway get skipped
+        if (!isLoadingLevel && isDungeon) UploadFrameLights(frameLights); //drops lights in unseen rooms
+
+        //gather up everything 2d and put it into a vector of struct drawRequests, then we sort and draw every billboard/quad in the game.
+        //gathered here so the billboards cull against this frame's frustum
+        GatherTransparentDrawRequests(camera, dt);
+
         rlDisableBackfaceCulling(); rlDisableDepthMask(); rlDisableDepthTest();
         DrawModel(ResourceManager::Get().GetModel("skyModel"), camera.position, 10000.0f, WHITE);
         rlEnableDepthMask(); rlEnableDepthTest();
         rlSetBlendMode(BLEND_ALPHA);
 
+        //opaque world draws push onto the render queue, one sorted flush draws them grouped by shader and material
         if (!isDungeon) {
 
-            DrawModel(terrainModel, {-terrainScale.x/2,0,-terrainScale.z/2}, 1.0f, WHITE);
-
-            DrawModel(ResourceManager::Get().GetModel("waterModel"), {0, waterPos.y + (float)sin(GetTime()*0.9f)*0.9f, 0}, 1.0f, WHITE);
-            DrawModel(ResourceManager::Get().GetModel("bottomPlane"), {0, waterHeightY - 100, 0}, 1.0f, DARKBLUE);
+            DrawTerrainChunks(terrainMaterial, camera.position);
+            RenderQueuePushModel(ResourceManager::Get().GetModel("bottomPlane"), {0, waterHeightY - 100, 0}, {0, 1, 0}, 0.0f, {1.0f, 1.0f, 1.0f}, DARKBLUE);
             DrawBoat(player_boat);
-            BeginShaderMode(ResourceManager::Get().GetShader("cutoutShader"));
-            DrawTrees(); 
-            DrawBushes(bushes); //alpha cuttout bushes as well as tree leaf
-            EndShaderMode();
             DrawDungeonDoorways();          
             DrawOverworldProps();
-        } else {
+            RenderQueueFlush(camera.position);
 
+            DrawModel(ResourceManager::Get().GetModel("waterModel"), {0, waterPos.y + (float)sin(GetTime()*0.9f)*0.9f, 0}, 1.0f, WHITE);
+            DrawTrees(); //instanced with LOD, alpha cutout happens in treeShader
+            DrawBushes(bushes);
+        } else {
             DrawDungeonFloor();
             DrawDungeonWalls();
             DrawDungeonDoorways();
-            DrawDungeonCeiling();
 
             DrawDungeonBarrels();
             DrawLaunchers();
             DrawDungeonChests();
             DrawDungeonPillars();
+            RenderQueueFlush(camera.position);
+
+            DrawDungeonCeiling(); //flushes on its own, needs culling and the isCeiling uniform
         }
 
         DrawPlayer(player, camera);
@@ -73,8 +95,8 @@ void RenderFrame(Camera3D& camera, Player& player, float dt) {
                             (float)sceneRT.texture.width,
                             -(float)sceneRT.texture.height }; // flip Y!
             Rectangle dst = { 0, 0,
-                            (float)GetScreenWidth(),
-                            (float)GetScreenHeight() };
+                            (float)sceneRT.texture.width,
+                            (float)sceneRT.texture.height }; // same size as the scene, not the window
             DrawTexturePro(sceneRT.texture, src, dst, {0,0}, 0.0f, WHITE);
         EndShaderMode();
     }
@@ -83,7 +105,7 @@ void RenderFrame(Camera3D& camera, Player& player, float dt) {
     // --- final to backbuffer + UI ---
     BeginDrawing();
         ClearBackground(WHITE);
-        BeginShaderMode(ResourceManager::Get().GetShader("bloomShader"));
+        BeginShaderMode(ResourceManager::Get().GetShader("bloomShader")); //also the upscale, bicubic in bloom.fs
             auto& postRT = ResourceManager::Get().GetRenderTexture("postProcessTexture");
             Rectangle src = { 0, 0,
                             (float)postRT.texture.width,
@@ -0,0 +1,120 @@
+#include "render/spriteAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "util/resourceManager.h"
+
+static const int kAtlasPageSize = 4096;
+static const int kAtlasPadding = 2; // keeps neighbouring sheets out of bilinear taps
+
+// everything GatherTransparentDrawRequests can hand to the billboard renderer. Doors stay out, they draw on
+// their own (depth mask, portal shader with its own uvs)
+static const char* kAtlasSprites[] = {
+    "raptorTexture", "trexSheet", "spiderSheet", "skeletonSheet", "pirateSheet", "ghostSheet",
+    "fireSheet", "muzzleFlash",
+    "bloodSheet", "biteSheet", "blockSheet", "slashSheet", "slashSheetLeft", "smokeSheet",
+    "explosionSheet", "bulletHoleSheet", "magicAttackSheet", "playerSlashSheet",
+    "healthPotTexture", "manaPotion", "keyTexture", "coinTexture",
+    "spiderWebTexture", "brokeWebTexture",
+};
+
+static std::vector<Texture2D> gPages;
+static std::unordered_map<unsigned int, AtlasRegion> gRegions; // by source texture id
+
+void BuildSpriteAtlas() {
+    UnloadSpriteAtlas();
+
+    struct Pending {
+        unsigned int sourceId;
+        Image image;
+    };
+    std::vector<Pending> pending;
+    for (const char* name : kAtlasSprites) {
+        Image image = LoadImage(("assets/sprites/" + std::string(name) + ".png").c_str());
+        if (!image.data) continue;
+        if (image.width + kAtlasPadding > kAtlasPageSize || image.height + kAtlasPadding > kAtlasPageSize) {
+            UnloadImage(image);
+            continue; // stays on its own texture
+        }
+        ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        pending.push_back({ ResourceManager::Get().GetTexture(name).id, image });
+    }
+
+    // shelf packing, tallest first
+    std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+        return a.image.height > b.image.height;
+    });
+
+    struct Page {
+        Image image;
+        int x = 0, y = 0, shelfHeight = 0;
+    };
+    std::vector<Page> pages;
+    std::vector<std::pair<int, Rectangle>> placed; // page, pixel rect, parallel to pending
+
+    for (const Pending& p : pending) {
+        const int w = p.image.width + kAtlasPadding;
+        const int h = p.image.height + kAtlasPadding;
+
+        int pageIndex = -1;
+        for (int i = 0; i < (int)pages.size() && pageIndex < 0; ++i) {
+            Page& page = pages[i];
+            if (page.x + w > kAtlasPageSize) { // next shelf
+                if (page.y + page.shelfHeight + h > kAtlasPageSize) continue;
+                page.y += page.shelfHeight;
+                page.x = 0;
+                page.shelfHeight = 0;
+            }
+            if (page.y + h <= kAtlasPageSize) pageIndex = i;
+        }
+        if (pageIndex < 0) {
+            Page page;
+            page.image = GenImageColor(kAtlasPageSize, kAtlasPageSize, BLANK);
+            pages.push_back(page);
+            pageIndex = (int)pages.size() - 1;
+        }
+
+        Page& page = pages[pageIndex];
+        const int rowBytes = p.image.width * 4;
+        unsigned char* dst = (unsigned char*)page.image.data;
+        const unsigned char* src = (const unsigned char*)p.image.data;
+        for (int row = 0; row < p.image.height; ++row) {
+            memcpy(dst + ((size_t)(page.y + row) * kAtlasPageSize + page.x) * 4, src + (size_t)row * rowBytes, rowBytes);
+        }
+
+        placed.push_back({ pageIndex, Rectangle{ (float)page.x, (float)page.y, (float)p.image.width, (float)p.image.height } });
+        page.x += w;
+        page.shelfHeight = std::max(page.shelfHeight, h);
+    }
+
+    for (Page& page : pages) {
+        gPages.push_back(LoadTextureFromImage(page.image));
+        UnloadImage(page.image);
+    }
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        const Rectangle r = placed[i].second;
+        gRegions[pending[i].sourceId] = {
+            gPages[placed[i].first].id,
+            { r.x / kAtlasPageSize, r.y / kAtlasPageSize, r.width / kAtlasPageSize, r.height / kAtlasPageSize }
+        };
+        UnloadImage(pending[i].image);
+    }
+
+    TraceLog(LOG_INFO, "Sprite atlas: %zu sheets on %zu page(s)", pending.size(), gPages.size());
+}
+
+void UnloadSpriteAtlas() {
+    for (Texture2D& page : gPages) UnloadTexture(page);
+    gPages.clear();
+    gRegions.clear();
+}
+
+AtlasRegion GetAtlasRegion(const Texture2D& texture) {
+    auto it = gRegions.find(texture.id);
+    if (it != gRegions.end()) return it->second;
+    return { texture.id, { 0.0f, 0.0f, 1.0f, 1.0f } };
+}
@@ -0,0 +1,236 @@
+#include "render/terrainChunks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "raymath.h"
+#include "render/frustum.h"
+#include "render/renderQueue.h"
+#include "util/job_pool.h"
+
+static const int kMaxLodBuildsPerFrame = 8;
+static const unsigned kEvictFrames = 120;     // fine LODs not drawn for this long are unloaded
+static const float kLodDistanceChunks = 2.0f; // LOD n out to kLodDistanceChunks * 2^n chunk widths
+static const float kSkirtMargin = 2.0f;       // skirts end this far below the chunk's lowest sample
+
+struct TerrainChunk {
+    int x0, z0, x1, z1; // heightmap samples, inclusive, neighbours share their edge samples
+    float minY = 0.0f;
+    float maxY = 0.0f;
+    BoundingBox bounds = {}; // skirts included
+    Mesh lods[kTerrainLodCount] = {};
+    unsigned lastDrawn[kTerrainLodCount] = {};
+};
+
+static std::vector<TerrainChunk> gChunks;
+static const unsigned char* gPixels = nullptr; // grayscale heightmap, owned by the caller
+static int gWidth = 0;
+static int gHeight = 0;
+static Vector3 gScale = {};
+static float gChunkWorldSize = 0.0f;
+static unsigned gFrame = 0;
+
+static float SampleHeight(int x, int z) {
+    x = std::clamp(x, 0, gWidth - 1);
+    z = std::clamp(z, 0, gHeight - 1);
+    return gPixels[z * gWidth + x] / 255.0f * gScale.y;
+}
+
+// same spacing as GenMeshHeightmap, shifted by the old draw offset
+static Vector3 SamplePosition(int x, int z) {
+    return {
+        -gScale.x * 0.5f + x * gScale.x / (gWidth - 1),
+        SampleHeight(x, z),
+        -gScale.z * 0.5f + z * gScale.z / (gHeight - 1),
+    };
+}
+
+// central differences on the full resolution image, so every LOD shades alike
+static Vector3 SampleNormal(int x, int z) {
+    const float dx = (SampleHeight(x + 1, z) - SampleHeight(x - 1, z)) / (2.0f * gScale.x / (gWidth - 1));
+    const float dz = (SampleHeight(x, z + 1) - SampleHeight(x, z - 1)) / (2.0f * gScale.z / (gHeight - 1));
+    return Vector3Normalize({ -dx, 1.0f, -dz });
+}
+
+static std::vector<int> LodSamples(int from, int to, int step) {
+    std::vector<int> samples;
+    for (int i = from; i < to; i += step) samples.push_back(i);
+    samples.push_back(to);
+    return samples;
+}
+
+static Mesh BuildChunkMesh(const TerrainChunk& chunk, int lod) {
+    const int step = 1 << lod;
+    const std::vector<int> xs = LodSamples(chunk.x0, chunk.x1, step);
+    const std::vector<int> zs = LodSamples(chunk.z0, chunk.z1, step);
+    const int nx = (int)xs.size();
+    const int nz = (int)zs.size();
+
+    Mesh mesh = {};
+    mesh.vertexCount = nx * nz + 2 * (nx + nz);
+    mesh.triangleCount = (nx - 1) * (nz - 1) * 2 + 4 * ((nx - 1) + (nz - 1));
+    mesh.vertices = (float*)MemAlloc(sizeof(float) * 3 * mesh.vertexCount);
+    mesh.normals = (float*)MemAlloc(sizeof(float) * 3 * mesh.vertexCount);
+    mesh.indices = (unsigned short*)MemAlloc(sizeof(unsigned short) * 3 * mesh.triangleCount);
+
+    int v = 0;
+    int t = 0;
+    auto put = [&](Vector3 p, Vector3 n) {
+        mesh.vertices[v*3 + 0] = p.x; mesh.vertices[v*3 + 1] = p.y; mesh.vertices[v*3 + 2] = p.z;
+        mesh.normals[v*3 + 0] = n.x;  mesh.normals[v*3 + 1] = n.y;  mesh.normals[v*3 + 2] = n.z;
+        return v++;
+    };
+    auto position = [&](int i) {
+        return Vector3{ mesh.vertices[i*3 + 0], mesh.vertices[i*3 + 1], mesh.vertices[i*3 + 2] };
+    };
+    auto tri = [&](int a, int b, int c) {
+        mesh.indices[t++] = (unsigned short)a;
+        mesh.indices[t++] = (unsigned short)b;
+        mesh.indices[t++] = (unsigned short)c;
+    };
+    auto grid = [&](int i, int j) { return j * nx + i; };
+
+    for (int j = 0; j < nz; ++j) {
+        for (int i = 0; i < nx; ++i) put(SamplePosition(xs[i], zs[j]), SampleNormal(xs[i], zs[j]));
+    }
+
+    // same triangle split and winding as GenMeshHeightmap
+    for (int j = 0; j < nz - 1; ++j) {
+        for (int i = 0; i < nx - 1; ++i) {
+            const int a = grid(i, j), b = grid(i, j + 1), c = grid(i + 1, j), d = grid(i + 1, j + 1);
+            tri(a, b, c);
+            tri(c, b, d);
+        }
+    }
+
+    // a neighbour's edge only interpolates the shared edge samples, so a skirt down to just below this
+    // chunk's lowest sample covers any crack
+    const float skirtY = chunk.minY - kSkirtMargin;
+    auto skirt = [&](const std::vector<int>& edge, Vector3 outward) {
+        const int base = v;
+        for (int k : edge) {
+            Vector3 p = position(k);
+            p.y = skirtY;
+            put(p, { mesh.normals[k*3 + 0], mesh.normals[k*3 + 1], mesh.normals[k*3 + 2] });
+        }
+        for (int k = 0; k + 1 < (int)edge.size(); ++k) {
+            const int t0 = edge[k], t1 = edge[k + 1], b0 = base + k, b1 = base + k + 1;
+            const Vector3 n = Vector3CrossProduct(Vector3Subtract(position(b0), position(t0)),
+                                                  Vector3Subtract(position(t1), position(t0)));
+            if (Vector3DotProduct(n, outward) >= 0.0f) { tri(t0, b0, t1); tri(t1, b0, b1); }
+            else                                       { tri(t0, t1, b0); tri(t1, b1, b0); }
+        }
+    };
+
+    std::vector<int> edge;
+    edge.clear(); for (int i = 0; i < nx; ++i) edge.push_back(grid(i, 0));
+    skirt(edge, { 0.0f, 0.0f, -1.0f });
+    edge.clear(); for (int i = 0; i < nx; ++i) edge.push_back(grid(i, nz - 1));
+    skirt(edge, { 0.0f, 0.0f, 1.0f });
+    edge.clear(); for (int j = 0; j < nz; ++j) edge.push_back(grid(0, j));
+    skirt(edge, { -1.0f, 0.0f, 0.0f });
+    edge.clear(); for (int j = 0; j < nz; ++j) edge.push_back(grid(nx - 1, j));
+    skirt(edge, { 1.0f, 0.0f, 0.0f });
+
+    return mesh;
+}
+
+void BuildTerrainChunks(const Image& heightmap, Vector3 terrainScale) {
+    UnloadTerrainChunks();
+    if (!heightmap.data || heightmap.width < 2 || heightmap.height < 2) return;
+
+    gPixels = (const unsigned char*)heightmap.data;
+    gWidth = heightmap.width;
+    gHeight = heightmap.height;
+    gScale = terrainScale;
+    gChunkWorldSize = kTerrainChunkQuads * terrainScale.x / (gWidth - 1);
+
+    for (int z0 = 0; z0 < gHeight - 1; z0 += kTerrainChunkQuads) {
+        for (int x0 = 0; x0 < gWidth - 1; x0 += kTerrainChunkQuads) {
+            TerrainChunk chunk;
+            chunk.x0 = x0;
+            chunk.z0 = z0;
+            chunk.x1 = std::min(x0 + kTerrainChunkQuads, gWidth - 1);
+            chunk.z1 = std::min(z0 + kTerrainChunkQuads, gHeight - 1);
+            gChunks.push_back(chunk);
+        }
+    }
+
+    // bounds and the resident LODs on the pool, uploads need the GL thread
+    JobPool::Get().ParallelFor(gChunks.size(), 4, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            TerrainChunk& chunk = gChunks[c];
+            chunk.minY = gScale.y;
+            chunk.maxY = 0.0f;
+            for (int z = chunk.z0; z <= chunk.z1; ++z) {
+                for (int x = chunk.x0; x <= chunk.x1; ++x) {
+                    const float h = SampleHeight(x, z);
+                    chunk.minY = std::min(chunk.minY, h);
+                    chunk.maxY = std::max(chunk.maxY, h);
+                }
+            }
+
+            const Vector3 lo = SamplePosition(chunk.x0, chunk.z0);
+            const Vector3 hi = SamplePosition(chunk.x1, chunk.z1);
+            chunk.bounds = { { lo.x, chunk.minY - kSkirtMargin, lo.z }, { hi.x, chunk.maxY, hi.z } };
+
+            for (int lod = kTerrainResidentLod; lod < kTerrainLodCount; ++lod) {
+                chunk.lods[lod] = BuildChunkMesh(chunk, lod);
+            }
+        }
+    });
+
+    for (TerrainChunk& chunk : gChunks) {
+        for (int lod = kTerrainResidentLod; lod < kTerrainLodCount; ++lod) UploadMesh(&chunk.lods[lod], false);
+    }
+}
+
+void UnloadTerrainChunks() {
+    for (TerrainChunk& chunk : gChunks) {
+        for (Mesh& mesh : chunk.lods) {
+            if (mesh.vertexCount > 0) UnloadMesh(mesh);
+        }
+    }
+    gChunks.clear();
+    gPixels = nullptr;
+}
+
+static int DesiredLod(const TerrainChunk& chunk, Vector3 cameraPos) {
+    const Vector3 nearest = Vector3Clamp(cameraPos, chunk.bounds.min, chunk.bounds.max);
+    const float dist = Vector3Distance(cameraPos, nearest);
+
+    float limit = kLodDistanceChunks * gChunkWorldSize;
+    for (int lod = 0; lod < kTerrainLodCount - 1; ++lod, limit *= 2.0f) {
+        if (dist < limit) return lod;
+    }
+    return kTerrainLodCount - 1;
+}
+
+void DrawTerrainChunks(const Material& material, Vector3 cameraPos) {
+    ++gFrame;
+    int builds = 0;
+    const Matrix identity = MatrixIdentity(); // vertices are already in world space
+
+    for (TerrainChunk& chunk : gChunks) {
+        if (BoxInView(chunk.bounds)) {
+            int lod = DesiredLod(chunk, cameraPos);
+            if (chunk.lods[lod].vertexCount == 0 && builds < kMaxLodBuildsPerFrame) {
+                chunk.lods[lod] = BuildChunkMesh(chunk, lod);
+                UploadMesh(&chunk.lods[lod], false);
+                ++builds;
+            }
+            while (chunk.lods[lod].vertexCount == 0) ++lod; // the resident LODs are always there
+
+            chunk.lastDrawn[lod] = gFrame;
+            const Vector3 center = Vector3Scale(Vector3Add(chunk.bounds.min, chunk.bounds.max), 0.5f);
+            RenderQueuePush(chunk.lods[lod], material, identity, WHITE, center);
+        }
+
+        for (int lod = 0; lod < kTerrainResidentLod; ++lod) {
+            if (chunk.lods[lod].vertexCount > 0 && gFrame - chunk.lastDrawn[lod] > kEvictFrames) {
+                UnloadMesh(chunk.lods[lod]);
+                chunk.lods[lod] = {};
+            }
+        }
+    }
+}
@@ -1,16 +1,44 @@
 #include "render/transparentDraw.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
 #include <vector>
 #include "raylib.h"
 #include "raymath.h"
 #include "rlgl.h"
 #include "char/character.h"
+#include "render/frustum.h"
+#include "render/spriteAtlas.h"
 #include "util/resourceManager.h"
+#include "world/rooms.h"
 #include "world/world.h"
 
 std::vector<BillboardDrawRequest> billboardRequests;
 
+struct BillboardTexture {
+    Texture2D texture;
+    AtlasRegion region; // looked up once per frame, not per quad
+};
+
+static std::vector<BillboardTexture> gTextures;
+
+// draw order, indices into billboardRequests. Kept from the previous frame, see SortBillboardRequests
+static std::vector<uint32_t> gOrder;
+static std::vector<uint32_t> gOrderScratch;
+static std::vector<uint32_t> gDepthKeys;
+
+uint16_t BillboardTextureIndex(const Texture2D& texture) {
+    //a gather pushes runs of the same texture, check the last one first
+    if (!gTextures.empty() && gTextures.back().texture.id == texture.id) return (uint16_t)(gTextures.size() - 1);
+    for (size_t i = 0; i < gTextures.size(); ++i) {
+        if (gTextures[i].texture.id == texture.id) return (uint16_t)i;
+    }
+    gTextures.push_back({ texture, GetAtlasRegion(texture) });
+    return (uint16_t)(gTextures.size() - 1);
+}
+
 float GetAdjustedBillboardSize(float baseSize, float distance) {
     //billboard scalling is way to extreme because of the size of the world. compensate by enlarging it a tiny bit depending on distance. 
     const float compensationFactor = 0.0001f;
@@ -19,6 +47,11 @@ float GetAdjustedBillboardSize(float baseSize, float distance) {
     return baseSize * (1.0f + distance * compensationFactor);
 }
 
+// Quads are size x size, doors size x 1.225 size, centered or bottom anchored. One sphere covers all of them.
+static inline bool BillboardInView(Vector3 position, float size) {
+    return SphereInView(position, size * 1.225f) && RoomsInView(position, 0.0f);
+}
+
 
 void GatherEnemies(Camera& camera) {
     //gather functions replace character.draw()
@@ -28,7 +61,8 @@ void GatherEnemies(Camera& camera) {
     for (Character* enemy : enemyPtrs) {
         if (enemy->isDead && enemy->deathTimer <= 0.0f) continue;
 
-        float dist = Vector3Distance(camera.position, enemy->position);
+        float distSqr = Vector3DistanceSqr(camera.position, enemy->position);
+        float dist = sqrtf(distSqr);
 
         // Frame source rectangle
         Rectangle sourceRect = {
@@ -45,6 +79,7 @@ void GatherEnemies(Camera& camera) {
        
         //compensate for extreme billboard scaling, things shrink at a distance but not by much. 
         float billboardSize = GetAdjustedBillboardSize(enemy->frameWidth * enemy->scale, dist);
+        if (!BillboardInView(offsetPos, billboardSize)) continue;
         // Dynamic tint for damage
         Color finalTint = (enemy->hitTimer > 0.0f) ? (Color){255, 50, 50, 255} : WHITE;
         if (enemy->state == CharacterState::Freeze){
@@ -52,14 +87,14 @@ void GatherEnemies(Camera& camera) {
         }
 
         billboardRequests.push_back({
-            Billboard_FacingCamera,//BillboardType
             offsetPos, //billboard position + z fighting offset
-            enemy->texture,
             sourceRect,
             billboardSize,
-            finalTint,
-            dist,
+            distSqr,
             0.0f,
+            finalTint,
+            BillboardTextureIndex(enemy->texture),
+            Billboard_FacingCamera,
             false
         });
 
@@ -69,17 +104,16 @@ void GatherEnemies(Camera& camera) {
 
 void GatherCollectables(Camera& camera, const std::vector<Collectable>& collectables) {
     for (const Collectable& c : collectables) {
-        float dist = Vector3Distance(camera.position, c.position);
-
+        if (!BillboardInView(c.position, c.scale)) continue;
         billboardRequests.push_back({
-            Billboard_FacingCamera, 
             c.position,
-            c.icon,
             Rectangle{0, 0, (float)c.icon.width, (float)c.icon.height},
             c.scale,
-            WHITE,
-            dist,
+            Vector3DistanceSqr(camera.position, c.position),
             0.0f,
+            WHITE,
+            BillboardTextureIndex(c.icon),
+            Billboard_FacingCamera,
             false
         });
     }
@@ -112,18 +146,18 @@ void GatherDungeonFires(Camera& camera, float deltaTime) {
         // Compute fire position
         Vector3 firePos = pillar.position;
         firePos.y += 130;
+        if (!BillboardInView(firePos, 100.0f)) continue; //after the animation, it keeps ticking off screen
 
         // Add to billboard requests
-        float dist = Vector3Distance(camera.position, firePos);
         billboardRequests.push_back({
-            Billboard_FacingCamera,
             firePos,
-            ResourceManager::Get().GetTexture("fireSheet"),
             sourceRect,
             100.0f,
-            WHITE,
-            dist,
+            Vector3DistanceSqr(camera.position, firePos),
             0.0f,
+            WHITE,
+            BillboardTextureIndex(ResourceManager::Get().GetTexture("fireSheet")),
+            Billboard_FacingCamera,
             false
         });
     }
@@ -135,16 +169,17 @@ void GatherWebs(Camera& camera) {
         //if (web.destroyed && !web.showBrokeWebTexture) continue;
 
         Texture2D tex = web.destroyed ? ResourceManager::Get().GetTexture("brokeWebTexture") : ResourceManager::Get().GetTexture("spiderWebTexture");
+        if (!BillboardInView(web.position, 400.0f)) continue;
 
         billboardRequests.push_back({
-            Billboard_FixedFlat,
             web.position,
-            tex,
             Rectangle{0, 0, (float)tex.width, (float)tex.height},
             400.0f,
-            WHITE,
-            Vector3Distance(camera.position, web.position),
+            Vector3DistanceSqr(camera.position, web.position),
             web.rotationY,
+            WHITE,
+            BillboardTextureIndex(tex),
+            Billboard_FixedFlat,
             false
         });
     }
@@ -153,16 +188,17 @@ void GatherWebs(Camera& camera) {
 void GatherDoors(Camera& camera) {
     for (const Door& door : doors) {
         if (door.isOpen) continue;
+        if (!BillboardInView(door.position, door.scale.x)) continue;
 
         billboardRequests.push_back({
-            Billboard_Door,
             door.position,
-            door.doorTexture,
             Rectangle{ 0, 0, (float)door.doorTexture.width, (float)door.doorTexture.height },
             door.scale.x, // width, used in size
-            door.tint,
-            Vector3Distance(camera.position, door.position),
+            Vector3DistanceSqr(camera.position, door.position),
             door.rotationY,
+            door.tint,
+            BillboardTextureIndex(door.doorTexture),
+            Billboard_Door,
             door.isPortal
         });
     }
@@ -173,8 +209,7 @@ void GatherDoors(Camera& camera) {
 void GatherDecals(Camera& camera, const std::vector<Decal>& decals) {
     for (const Decal& decal : decals) {
         if (!decal.alive) continue;
-
-        float dist = Vector3Distance(camera.position, decal.position);
+        if (!BillboardInView(decal.position, decal.size)) continue;
 
         Rectangle sourceRect;
 
@@ -204,14 +239,14 @@ void GatherDecals(Camera& camera, const std::vector<Decal>& decals) {
         }
 
         billboardRequests.push_back({
-            Billboard_Decal,
             decal.position,
-            decal.texture,
             sourceRect,
             decal.size,
-            WHITE,
-            dist,
+            Vector3DistanceSqr(camera.position, decal.position),
             0.0f,
+            WHITE,
+            BillboardTextureIndex(decal.texture),
+            Billboard_Decal,
             false
         });
     }
@@ -219,17 +254,17 @@ void GatherDecals(Camera& camera, const std::vector<Decal>& decals) {
 
 void GatherMuzzleFlashes(Camera& camera, const std::vector<MuzzleFlash>& flashes) {
     for (const auto& flash : flashes) {
-        float dist = Vector3Distance(camera.position, flash.position);
-        
+        if (!BillboardInView(flash.position, flash.size)) continue;
+
         billboardRequests.push_back({
-            Billboard_FacingCamera,
             flash.position,
-            flash.texture,
             Rectangle{0, 0, (float)flash.texture.width, (float)flash.texture.height},
             flash.size,
-            WHITE,
-            dist,
+            Vector3DistanceSqr(camera.position, flash.position),
             0.0f,
+            WHITE,
+            BillboardTextureIndex(flash.texture),
+            Billboard_FacingCamera,
             false
         });
     }
@@ -237,6 +272,7 @@ void GatherMuzzleFlashes(Camera& camera, const std::vector<MuzzleFlash>& flashes
 
 void GatherTransparentDrawRequests(Camera& camera, float deltaTime) {
     billboardRequests.clear();
+    gTextures.clear();
 
     GatherEnemies(camera);
     GatherDungeonFires(camera, deltaTime);
@@ -247,38 +283,142 @@ void GatherTransparentDrawRequests(Camera& camera, float deltaTime) {
     GatherCollectables(camera, collectables);
 }
 
+// uv (s, t) of the request's own texture, moved into its atlas region
+static inline void AtlasTexCoord(const AtlasRegion& region, float s, float t) {
+    rlTexCoord2f(region.uv.x + s * region.uv.width, region.uv.y + t * region.uv.height);
+}
+
+// Same quad as DrawBillboardRec (world up, centered on the position), with the atlas uvs. Consecutive quads
+// on the same atlas page land in the same rlgl draw.
+static void BatchBillboard(const BillboardDrawRequest& req, Vector3 cameraRight) {
+    const Texture2D& texture = gTextures[req.textureIndex].texture;
+    const AtlasRegion& region = gTextures[req.textureIndex].region;
+    const float half = req.size * 0.5f;
+    const Vector3 r = Vector3Scale(cameraRight, half);
+    const Vector3 p = req.position;
+
+    const float s0 = req.sourceRect.x / texture.width;
+    const float s1 = (req.sourceRect.x + req.sourceRect.width) / texture.width;
+    const float t0 = req.sourceRect.y / texture.height;
+    const float t1 = (req.sourceRect.y + req.sourceRect.height) / texture.height;
+
+    rlSetTexture(region.textureId);
+    rlBegin(RL_QUADS);
+        rlColor4ub(req.tint.r, req.tint.g, req.tint.b, req.tint.a);
+        AtlasTexCoord(region, s0, t1); rlVertex3f(p.x - r.x, p.y - half, p.z - r.z);
+        AtlasTexCoord(region, s1, t1); rlVertex3f(p.x + r.x, p.y - half, p.z + r.z);
+        AtlasTexCoord(region, s1, t0); rlVertex3f(p.x + r.x, p.y + half, p.z + r.z);
+        AtlasTexCoord(region, s0, t0); rlVertex3f(p.x - r.x, p.y + half, p.z - r.z);
+    rlEnd();
+}
+
+// DrawFlatWeb's quad, whole texture, through the atlas
+static void BatchFlatQuad(const BillboardDrawRequest& req) {
+    const AtlasRegion& region = gTextures[req.textureIndex].region;
+    const Matrix rot = MatrixRotateY(req.rotationY);
+    const float half = req.size * 0.5f;
+    const Vector3 c[4] = {
+        Vector3Add(Vector3Transform({ -half, -half, 0.0f }, rot), req.position),
+        Vector3Add(Vector3Transform({  half, -half, 0.0f }, rot), req.position),
+        Vector3Add(Vector3Transform({  half,  half, 0.0f }, rot), req.position),
+        Vector3Add(Vector3Transform({ -half,  half, 0.0f }, rot), req.position),
+    };
+
+    rlSetTexture(region.textureId);
+    rlBegin(RL_QUADS);
+        rlColor4ub(req.tint.r, req.tint.g, req.tint.b, req.tint.a);
+        AtlasTexCoord(region, 0.0f, 0.0f); rlVertex3f(c[0].x, c[0].y, c[0].z);
+        AtlasTexCoord(region, 1.0f, 0.0f); rlVertex3f(c[1].x, c[1].y, c[1].z);
+        AtlasTexCoord(region, 1.0f, 1.0f); rlVertex3f(c[2].x, c[2].y, c[2].z);
+        AtlasTexCoord(region, 0.0f, 1.0f); rlVertex3f(c[3].x, c[3].y, c[3].z);
+    rlEnd();
+}
+
+// Far to near. Squared distance is a positive float, so its bits already sort like the value; dropping the low
+// 9 mantissa bits leaves 22 bits (about 1/16000 relative precision), two 11 bit radix passes.
+static const int kRadixBits = 11;
+static const uint32_t kRadixMask = (1u << kRadixBits) - 1;
+static const uint32_t kDepthKeyMax = (1u << (2 * kRadixBits)) - 1;
+
+static inline uint32_t DepthKey(float distanceSqr) {
+    uint32_t bits;
+    memcpy(&bits, &distanceSqr, sizeof(bits));
+    return kDepthKeyMax - std::min(bits >> 9, kDepthKeyMax); //invert, farthest first
+}
+
+static void RadixSortOrder(size_t count) {
+    gOrder.resize(count);
+    gOrderScratch.resize(count);
+    for (size_t i = 0; i < count; ++i) gOrder[i] = (uint32_t)i;
+
+    uint32_t histogram[1u << kRadixBits];
+    for (int pass = 0; pass < 2; ++pass) {
+        const int shift = pass * kRadixBits;
+        std::fill(std::begin(histogram), std::end(histogram), 0u);
+        for (uint32_t index : gOrder) ++histogram[(gDepthKeys[index] >> shift) & kRadixMask];
+
+        uint32_t sum = 0;
+        for (uint32_t& bucket : histogram) {
+            const uint32_t n = bucket;
+            bucket = sum;
+            sum += n;
+        }
+        for (uint32_t index : gOrder) gOrderScratch[histogram[(gDepthKeys[index] >> shift) & kRadixMask]++] = index;
+        gOrder.swap(gOrderScratch);
+    }
+}
+
+// Gathers run in the same order every frame, so with the same request count index i is very likely the same
+// thing as last frame and last frame's order is almost sorted. Fix it up with an insertion sort, and give up
+// for the radix sort once it has done more shifting than a nearly sorted list should need.
+static bool InsertionSortOrder() {
+    size_t budget = gOrder.size() * 4;
+    for (size_t i = 1; i < gOrder.size(); ++i) {
+        const uint32_t index = gOrder[i];
+        const uint32_t key = gDepthKeys[index];
+        size_t j = i;
+        while (j > 0 && gDepthKeys[gOrder[j - 1]] > key) {
+            gOrder[j] = gOrder[j - 1];
+            --j;
+            if (budget-- == 0) return false;
+        }
+        gOrder[j] = index;
+    }
+    return true;
+}
+
+static void SortBillboardRequests() {
+    const size_t count = billboardRequests.size();
+    gDepthKeys.resize(count);
+    for (size_t i = 0; i < count; ++i) gDepthKeys[i] = DepthKey(billboardRequests[i].distanceSqr);
+
+    //a bailed insertion sort leaves gOrder half shifted, the radix sort rebuilds it from scratch
+    if (gOrder.size() != count || !InsertionSortOrder()) RadixSortOrder(count);
+}
+
 void DrawTransparentDrawRequests(Camera& camera) {
-    //sort and draw the drawRequest structs. 
-    std::sort(billboardRequests.begin(), billboardRequests.end(),
-        [](const BillboardDrawRequest& a, const BillboardDrawRequest& b) {
-            return a.distanceToCamera > b.distanceToCamera;
-        });
+    //sort and draw the drawRequest structs, farthest first
+    SortBillboardRequests();
 
-    for (const BillboardDrawRequest& req : billboardRequests) {
-        //use alpha cut out shader on everything. treeShader does the fog at a distance thing + alpha cutout
-        if (!isDungeon) BeginShaderMode(ResourceManager::Get().GetShader("treeShader"));
-        if (isDungeon) BeginShaderMode(ResourceManager::Get().GetShader("cutoutShader"));
+    //use alpha cut out shader on everything. treeShader does the fog at a distance thing + alpha cutout
+    //bound once for the whole list, so neighbouring requests with the same texture stay in one rlgl batch
+    Shader billboardShader = ResourceManager::Get().GetShader(isDungeon ? "cutoutShader" : "treeShader");
+    BeginShaderMode(billboardShader);
+
+    //sheets are packed into the sprite atlas, so the sorted quads below mostly share one texture and go out
+    //as one rlgl vertex buffer, in sorted order. only doors break the run
+    Matrix matView = MatrixLookAt(camera.position, camera.target, camera.up);
+    Vector3 cameraRight = { matView.m0, matView.m4, matView.m8 };
+
+    for (uint32_t index : gOrder) {
+        const BillboardDrawRequest& req = billboardRequests[index];
         switch (req.type) {
-            case Billboard_FacingCamera: //use draw billboard for both decals, and enemies. 
+            case Billboard_FacingCamera: //same quad for decals and enemies
             case Billboard_Decal:
-                DrawBillboardRec(
-                    camera,
-                    (req.texture),
-                    req.sourceRect,
-                    req.position,
-                    Vector2{req.size, req.size},
-                    req.tint
-                );
+                BatchBillboard(req, cameraRight);
                 break;
             case Billboard_FixedFlat: //special case for webs
-                DrawFlatWeb(
-                    (req.texture),
-                    req.position,
-                    req.size,
-                    req.size,
-                    req.rotationY,
-                    req.tint
-                );
+                BatchFlatQuad(req);
                 break;
 
             case Billboard_Door:
@@ -286,15 +426,19 @@ void DrawTransparentDrawRequests(Camera& camera) {
                 //we added another field to drawRequest just for portal doors. We could mark other things as portal an apply the same wacky color shader to them. 
                 //maybe we could protal shader ghost. 
                 DrawFlatDoor(
-                    (req.texture), 
+                    gTextures[req.textureIndex].texture,
                     req.position, 
                     req.size, 
                     req.size * 1.225f, 
                     req.rotationY, 
                     req.tint);
+                //DrawFlatDoor ends shader mode and restores the depth mask, pick the list's shader back up
+                BeginShaderMode(billboardShader);
                 break;
         }
-        EndShaderMode();
-        rlEnableDepthMask();
     }
+
+    rlSetTexture(0);
+    EndShaderMode();
+    rlEnableDepthMask();
 }
@@ -0,0 +1,308 @@
+#include "render/vegetationBatch.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "raymath.h"
+#include "rlgl.h"
+#include "render/frustum.h"
+#include "util/resourceManager.h"
+
+static const int kClusterCells = 16;    // position grid over the mesh bounds, per axis
+static const int kClusterUvCells = 8;   // uv grid, keeps trunk and leaf cards from merging across the atlas
+static const float kMinSimplifyGain = 0.8f; // keep the simplified mesh only below this share of triangles
+static const int kImpostorSize = 256;
+
+struct VegetationLodConfig {
+    const char* modelName;
+    float simpleDist;   // full mesh closer than this
+    float impostorDist; // simplified mesh closer than this, impostor beyond
+};
+
+static const VegetationLodConfig kLodConfig[VEG_KIND_COUNT] = {
+    { "palmTree", 4000.0f, 9000.0f },
+    { "palm2",    4000.0f, 9000.0f },
+    { "bush",     2500.0f, 6000.0f },
+};
+
+struct VegetationLodSet {
+    Model* model = nullptr;
+    std::vector<Mesh> simpleMeshes;   // one per model mesh, vertexCount 0 where simplifying didn't pay off
+    RenderTexture2D impostor = {};
+    float impostorSize = 0.0f;        // side of the impostor square at scale 1
+    Vector3 impostorCenter = {};      // bounds center at scale 1, unrotated
+
+    std::vector<Matrix> transforms[2]; // full, simplified
+    std::vector<Vector4> impostors;    // xyz quad center, w scale
+};
+
+static VegetationLodSet gSets[VEG_KIND_COUNT];
+
+static Model& KindModel(int kind) {
+    VegetationLodSet& set = gSets[kind];
+    if (!set.model) set.model = &ResourceManager::Get().GetModel(kLodConfig[kind].modelName);
+    return *set.model;
+}
+
+// Vertex clustering: snap every vertex to a grid over the mesh bounds, keep one averaged vertex per
+// occupied cell and drop the triangles that collapse. False when the result isn't worth a second mesh.
+static bool SimplifyMesh(const Mesh& src, Mesh& out) {
+    if (!src.vertices || src.vertexCount < 3 || src.triangleCount < 1) return false;
+
+    Vector3 lo = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Vector3 hi = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (int v = 0; v < src.vertexCount; ++v) {
+        const Vector3 p = { src.vertices[v*3 + 0], src.vertices[v*3 + 1], src.vertices[v*3 + 2] };
+        lo = Vector3Min(lo, p);
+        hi = Vector3Max(hi, p);
+    }
+    const Vector3 size = Vector3Subtract(hi, lo);
+    const Vector3 inv = {
+        size.x > 0.0f ? kClusterCells / size.x : 0.0f,
+        size.y > 0.0f ? kClusterCells / size.y : 0.0f,
+        size.z > 0.0f ? kClusterCells / size.z : 0.0f,
+    };
+
+    std::unordered_map<uint64_t, int> cellToCluster;
+    std::vector<int> clusterOf(src.vertexCount);
+    std::vector<int> firstVertex;
+    std::vector<Vector3> positionSum;
+    std::vector<int> members;
+
+    for (int v = 0; v < src.vertexCount; ++v) {
+        const Vector3 p = { src.vertices[v*3 + 0], src.vertices[v*3 + 1], src.vertices[v*3 + 2] };
+        const uint64_t ix = (uint64_t)std::min((int)((p.x - lo.x) * inv.x), kClusterCells - 1);
+        const uint64_t iy = (uint64_t)std::min((int)((p.y - lo.y) * inv.y), kClusterCells - 1);
+        const uint64_t iz = (uint64_t)std::min((int)((p.z - lo.z) * inv.z), kClusterCells - 1);
+        uint64_t key = ix | (iy << 8) | (iz << 16);
+        if (src.texcoords) {
+            const uint64_t iu = (uint16_t)(int)floorf(src.texcoords[v*2 + 0] * kClusterUvCells);
+            const uint64_t iv = (uint16_t)(int)floorf(src.texcoords[v*2 + 1] * kClusterUvCells);
+            key |= (iu << 24) | (iv << 40);
+        }
+
+        auto it = cellToCluster.find(key);
+        if (it == cellToCluster.end()) {
+            it = cellToCluster.emplace(key, (int)firstVertex.size()).first;
+            firstVertex.push_back(v);
+            positionSum.push_back({ 0.0f, 0.0f, 0.0f });
+            members.push_back(0);
+        }
+        clusterOf[v] = it->second;
+        positionSum[it->second] = Vector3Add(positionSum[it->second], p);
+        members[it->second]++;
+    }
+
+    const int clusterCount = (int)firstVertex.size();
+    if (clusterCount > 65535) return false; // 16-bit indices
+
+    std::vector<unsigned short> indices;
+    indices.reserve((size_t)src.triangleCount * 3);
+    for (int t = 0; t < src.triangleCount; ++t) {
+        int c[3];
+        for (int k = 0; k < 3; ++k) {
+            const int v = src.indices ? (int)src.indices[t*3 + k] : t*3 + k;
+            c[k] = clusterOf[v];
+        }
+        if (c[0] == c[1] || c[1] == c[2] || c[0] == c[2]) continue;
+        for (int k = 0; k < 3; ++k) indices.push_back((unsigned short)c[k]);
+    }
+
+    const int kept = (int)indices.size() / 3;
+    if (kept == 0 || kept >= src.triangleCount * kMinSimplifyGain) return false;
+
+    out = {};
+    out.vertexCount = clusterCount;
+    out.triangleCount = kept;
+    out.vertices = (float*)MemAlloc(sizeof(float) * 3 * clusterCount);
+    if (src.texcoords) out.texcoords = (float*)MemAlloc(sizeof(float) * 2 * clusterCount);
+    if (src.normals) out.normals = (float*)MemAlloc(sizeof(float) * 3 * clusterCount);
+    out.indices = (unsigned short*)MemAlloc(sizeof(unsigned short) * indices.size());
+
+    for (int c = 0; c < clusterCount; ++c) {
+        const Vector3 p = Vector3Scale(positionSum[c], 1.0f / members[c]);
+        out.vertices[c*3 + 0] = p.x;
+        out.vertices[c*3 + 1] = p.y;
+        out.vertices[c*3 + 2] = p.z;
+
+        // uv and normal from the first vertex in the cell, the uv grid keeps them close to the rest
+        const int v = firstVertex[c];
+        if (out.texcoords) {
+            out.texcoords[c*2 + 0] = src.texcoords[v*2 + 0];
+            out.texcoords[c*2 + 1] = src.texcoords[v*2 + 1];
+        }
+        if (out.normals) {
+            out.normals[c*3 + 0] = src.normals[v*3 + 0];
+            out.normals[c*3 + 1] = src.normals[v*3 + 1];
+            out.normals[c*3 + 2] = src.normals[v*3 + 2];
+        }
+    }
+    std::copy(indices.begin(), indices.end(), out.indices);
+
+    UploadMesh(&out, false);
+    return true;
+}
+
+// Orthographic side view of the model at scale 1, framed on its bounds.
+static void CaptureImpostor(VegetationLodSet& set, Model& model) {
+    const BoundingBox b = GetModelBoundingBox(model);
+    const Vector3 center = Vector3Scale(Vector3Add(b.min, b.max), 0.5f);
+    const Vector3 size = Vector3Subtract(b.max, b.min);
+
+    set.impostorCenter = center;
+    set.impostorSize = std::max(size.x, size.y);
+    if (set.impostorSize <= 0.0f) return;
+
+    Camera3D cam = {};
+    cam.position = { center.x, center.y, b.max.z + 1.0f }; // stays inside the default ortho far plane
+    cam.target = center;
+    cam.up = { 0.0f, 1.0f, 0.0f };
+    cam.fovy = set.impostorSize; // view height for orthographic
+    cam.projection = CAMERA_ORTHOGRAPHIC;
+
+    // plain textured pass, no fog baked into the capture
+    std::vector<Shader> saved(model.materialCount);
+    Shader cutout = ResourceManager::Get().GetShader("cutoutShader");
+    for (int i = 0; i < model.materialCount; ++i) {
+        saved[i] = model.materials[i].shader;
+        model.materials[i].shader = cutout;
+    }
+
+    set.impostor = LoadRenderTexture(kImpostorSize, kImpostorSize);
+    BeginTextureMode(set.impostor);
+    ClearBackground(BLANK);
+    BeginMode3D(cam);
+    DrawModel(model, { 0.0f, 0.0f, 0.0f }, 1.0f, WHITE);
+    EndMode3D();
+    EndTextureMode();
+
+    for (int i = 0; i < model.materialCount; ++i) model.materials[i].shader = saved[i];
+
+    GenTextureMipmaps(&set.impostor.texture);
+    SetTextureFilter(set.impostor.texture, TEXTURE_FILTER_TRILINEAR);
+}
+
+void BuildVegetationLods() {
+    UnloadVegetationLods();
+
+    for (int kind = 0; kind < VEG_KIND_COUNT; ++kind) {
+        VegetationLodSet& set = gSets[kind];
+        Model& model = KindModel(kind);
+
+        set.simpleMeshes.assign(model.meshCount, Mesh{});
+        for (int i = 0; i < model.meshCount; ++i) {
+            Mesh simple = {};
+            if (SimplifyMesh(model.meshes[i], simple)) set.simpleMeshes[i] = simple;
+        }
+
+        CaptureImpostor(set, model);
+    }
+}
+
+void UnloadVegetationLods() {
+    for (VegetationLodSet& set : gSets) {
+        for (Mesh& mesh : set.simpleMeshes) {
+            if (mesh.vertexCount > 0) UnloadMesh(mesh);
+        }
+        set.simpleMeshes.clear();
+
+        if (set.impostor.id != 0) UnloadRenderTexture(set.impostor);
+        set.impostor = {};
+
+        set.transforms[0].clear();
+        set.transforms[1].clear();
+        set.impostors.clear();
+    }
+}
+
+void QueueVegetation(VegetationKind kind, Vector3 position, float rotationY, float scale, Vector3 cameraPos) {
+    VegetationLodSet& set = gSets[kind];
+    const VegetationLodConfig& cfg = kLodConfig[kind];
+    Model& model = KindModel(kind);
+    if (!SphereInView(position, ModelCullRadius(model) * scale)) return;
+
+    const float distSq = Vector3DistanceSqr(position, cameraPos);
+
+    if (set.impostor.id != 0 && distSq >= cfg.impostorDist * cfg.impostorDist) {
+        const Vector3 offset = Vector3RotateByAxisAngle(Vector3Scale(set.impostorCenter, scale),
+                                                        { 0.0f, 1.0f, 0.0f }, rotationY * DEG2RAD);
+        const Vector3 c = Vector3Add(position, offset);
+        set.impostors.push_back({ c.x, c.y, c.z, scale });
+        return;
+    }
+
+    // same order as DrawModelEx: model.transform * scale * rotation * translation
+    Matrix matTransform = MatrixMultiply(MatrixMultiply(MatrixScale(scale, scale, scale),
+                                                        MatrixRotateY(rotationY * DEG2RAD)),
+                                         MatrixTranslate(position.x, position.y, position.z));
+    const int lod = (distSq >= cfg.simpleDist * cfg.simpleDist) ? 1 : 0;
+    set.transforms[lod].push_back(MatrixMultiply(model.transform, matTransform));
+}
+
+static void DrawMeshes(const Model& model, const std::vector<Mesh>* simpleMeshes,
+                       const std::vector<Matrix>& transforms, Shader instanced) {
+    if (transforms.empty()) return;
+
+    for (int i = 0; i < model.meshCount; ++i) {
+        const bool useSimple = simpleMeshes && i < (int)simpleMeshes->size() && (*simpleMeshes)[i].vertexCount > 0;
+        const Mesh& mesh = useSimple ? (*simpleMeshes)[i] : model.meshes[i];
+
+        Material mat = model.materials[model.meshMaterial[i]];
+        mat.shader = instanced;
+        DrawMeshInstanced(mesh, mat, transforms.data(), (int)transforms.size());
+    }
+}
+
+// Y-axis billboards, corners built in world space so the whole model goes out as one rlgl batch.
+static void DrawImpostors(const VegetationLodSet& set, Vector3 cameraPos) {
+    if (set.impostors.empty() || set.impostor.id == 0) return;
+
+    Shader treeShader = ResourceManager::Get().GetShader("treeShader");
+    BeginShaderMode(treeShader);
+    const Matrix identity = MatrixIdentity();
+    const Vector4 white = { 1.0f, 1.0f, 1.0f, 1.0f };
+    SetShaderValueMatrix(treeShader, treeShader.locs[SHADER_LOC_MATRIX_MODEL], identity); // fog needs world fragPosition
+    SetShaderValue(treeShader, treeShader.locs[SHADER_LOC_COLOR_DIFFUSE], &white, SHADER_UNIFORM_VEC4);
+
+    rlSetTexture(set.impostor.texture.id);
+    rlBegin(RL_QUADS);
+    rlColor4ub(255, 255, 255, 255);
+    for (const Vector4& it : set.impostors) {
+        const float dx = cameraPos.x - it.x;
+        const float dz = cameraPos.z - it.z;
+        const float len = sqrtf(dx*dx + dz*dz);
+        if (len < 0.001f) continue;
+
+        const float half = set.impostorSize * it.w * 0.5f;
+        const float rx = dz / len * half; // right as seen from the camera
+        const float rz = -dx / len * half;
+
+        // render textures are stored bottom-up, so v runs from the bottom edge
+        rlTexCoord2f(0.0f, 0.0f); rlVertex3f(it.x - rx, it.y - half, it.z - rz);
+        rlTexCoord2f(1.0f, 0.0f); rlVertex3f(it.x + rx, it.y - half, it.z + rz);
+        rlTexCoord2f(1.0f, 1.0f); rlVertex3f(it.x + rx, it.y + half, it.z + rz);
+        rlTexCoord2f(0.0f, 1.0f); rlVertex3f(it.x - rx, it.y + half, it.z - rz);
+    }
+    rlEnd();
+    rlSetTexture(0);
+    EndShaderMode();
+}
+
+void DrawQueuedVegetation(Vector3 cameraPos) {
+    Shader instanced = ResourceManager::Get().GetShader("treeShaderInstanced");
+
+    for (VegetationLodSet& set : gSets) {
+        if (set.model) {
+            DrawMeshes(*set.model, nullptr, set.transforms[0], instanced);
+            DrawMeshes(*set.model, &set.simpleMeshes, set.transforms[1], instanced);
+            DrawImpostors(set, cameraPos);
+        }
+
+        set.transforms[0].clear();
+        set.transforms[1].clear();
+        set.impostors.clear();
+    }
+}
@@ -1,6 +1,8 @@
 #include "tools/boat.h"
 
 #include "raymath.h"
+#include "render/frustum.h"
+#include "render/renderQueue.h"
 #include "util/resourceManager.h"
 #include "world/world.h"
 
@@ -65,6 +67,8 @@ void DrawBoat(const Boat& boat) {
     float bob = sinf(GetTime() * 2.0f) * 2.0f;
     Vector3 drawPos = boat.position;
     if (!boat.beached) drawPos.y += bob;
-    
-    DrawModelEx(ResourceManager::Get().GetModel("boatModel"), drawPos, {0, 1, 0}, boat.rotationY, {1.0f, 1.0f, 1.0f}, WHITE);
+
+    Model& boatModel = ResourceManager::Get().GetModel("boatModel");
+    if (!SphereInView(drawPos, ModelCullRadius(boatModel))) return;
+    RenderQueuePushModel(boatModel, drawPos, {0, 1, 0}, boat.rotationY, {1.0f, 1.0f, 1.0f}, WHITE);
 }
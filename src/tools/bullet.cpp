@@ -20,7 +20,13 @@ Bullet::Bullet(Vector3 startPos, Vector3 vel, float lifetime, bool en, BulletTyp
       radius(r),
       launcher(launch),
       type(t)
-{}
+{
+    //enemy shots can hit the player and, through the skeleton's mask, other enemies
+    if (enemy) {
+        collisionLayer = LAYER_ENEMY_PROJECTILE;
+        collisionMask = LAYER_PLAYER | LAYER_ENEMY | LAYER_STATIC | LAYER_DESTRUCTIBLE;
+    }
+}
 
 
 void Bullet::UpdateMagicBall(Camera& camera, float deltaTime) {
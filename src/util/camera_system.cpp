@@ -1,6 +1,7 @@
 #include "util/camera_system.h"
 
 #include "rlgl.h"
+#include "render/frustum.h"
 #include "world/world.h"
 
 CameraSystem& CameraSystem::Get() {
@@ -107,4 +108,6 @@ void CameraSystem::BeginCustom3D(const Camera3D& cam, float nearClip, float farC
     rlLoadIdentity();
     Matrix view = MatrixLookAt(cam.position, cam.target, cam.up);
     rlMultMatrixf(MatrixToFloat(view));
+
+    SetViewFrustum(FrustumFromMatrices(view, proj)); //everything drawn in this 3D pass culls against it
 }
@@ -0,0 +1,326 @@
+#include "util/collisionWorld.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define COLLISION_SSE2 1
+#endif
+
+#include "world/world.h"
+#include "world/dungeonGeneration.h"
+
+ColliderSoA gStaticColliders;
+ColliderGrid gStaticGrid;
+ColliderSoA gDynamicColliders;
+
+// padding boxes sit far outside any level with min > max, so their distance is always huge but finite
+static constexpr float kPadFar = 1.0e18f;
+
+// what the level geometry reacts to
+static constexpr uint32_t kStaticMask = LAYER_PROJECTILES | LAYER_CHARACTERS;
+
+void ColliderSoA::Clear() {
+    minX.clear(); minY.clear(); minZ.clear();
+    maxX.clear(); maxY.clear(); maxZ.clear();
+    radiusScale.clear();
+    layer.clear();
+    mask.clear();
+    kind.clear();
+    owner.clear();
+    sub.clear();
+    count = 0;
+}
+
+void ColliderSoA::Reserve(size_t n) {
+    minX.reserve(n); minY.reserve(n); minZ.reserve(n);
+    maxX.reserve(n); maxY.reserve(n); maxZ.reserve(n);
+    radiusScale.reserve(n);
+    layer.reserve(n);
+    mask.reserve(n);
+    kind.reserve(n);
+    owner.reserve(n);
+    sub.reserve(n);
+}
+
+void ColliderSoA::Push(const BoundingBox& box, ColliderKind k, int ownerIndex, float scale,
+                       uint32_t layerBits, uint32_t maskBits, int subIndex) {
+    minX.push_back(box.min.x); minY.push_back(box.min.y); minZ.push_back(box.min.z);
+    maxX.push_back(box.max.x); maxY.push_back(box.max.y); maxZ.push_back(box.max.z);
+    radiusScale.push_back(scale);
+    layer.push_back(layerBits);
+    mask.push_back(maskBits);
+    kind.push_back(k);
+    owner.push_back(ownerIndex);
+    sub.push_back(subIndex);
+    count++;
+}
+
+void ColliderSoA::Pad() {
+    while (minX.size() % 4 != 0) {
+        minX.push_back(kPadFar); minY.push_back(kPadFar); minZ.push_back(kPadFar);
+        maxX.push_back(-kPadFar); maxY.push_back(-kPadFar); maxZ.push_back(-kPadFar);
+        radiusScale.push_back(0.0f);
+        layer.push_back(LAYER_NONE);
+        mask.push_back(LAYER_NONE);
+        kind.push_back(ColliderKind::Wall);
+        owner.push_back(-1);
+        sub.push_back(-1);
+    }
+}
+
+void BulletSoA::Clear() {
+    px.clear(); py.clear(); pz.clear(); r.clear();
+    layer.clear(); mask.clear();
+    index.clear();
+}
+
+void ColliderGrid::Clear() {
+    cellsX = cellsZ = 0;
+    cellStart.clear();
+    cellEnd.clear();
+    cellLayers.clear();
+}
+
+struct StaticEntry {
+    BoundingBox box;
+    ColliderKind kind;
+    int owner;
+    uint32_t mask;
+};
+
+void BuildStaticColliders() {
+    //walls, pillars, chests and launchers never move, build them once after dungeon generation.
+    std::vector<StaticEntry> entries;
+    entries.reserve(wallRunColliders.size() + pillars.size() + chestInstances.size() + launchers.size());
+    for (size_t i = 0; i < wallRunColliders.size(); i++) {
+        entries.push_back({ wallRunColliders[i].bounds, ColliderKind::Wall, (int)i, kStaticMask });
+    }
+    for (size_t i = 0; i < pillars.size(); i++) {
+        entries.push_back({ pillars[i].bounds, ColliderKind::Pillar, (int)i, kStaticMask });
+    }
+    //bullets fly through chests and launchers, they only block characters
+    for (size_t i = 0; i < chestInstances.size(); i++) {
+        entries.push_back({ chestInstances[i].bounds, ColliderKind::Chest, (int)i, LAYER_CHARACTERS });
+    }
+    for (size_t i = 0; i < launchers.size(); i++) {
+        entries.push_back({ launchers[i].bounds, ColliderKind::Launcher, (int)i, LAYER_PLAYER });
+    }
+
+    ClearStaticColliders();
+    if (entries.empty()) return;
+
+    ColliderGrid& g = gStaticGrid;
+    float minX = entries[0].box.min.x, minZ = entries[0].box.min.z;
+    float maxX = entries[0].box.max.x, maxZ = entries[0].box.max.z;
+    for (const StaticEntry& e : entries) {
+        minX = std::min(minX, e.box.min.x); minZ = std::min(minZ, e.box.min.z);
+        maxX = std::max(maxX, e.box.max.x); maxZ = std::max(maxZ, e.box.max.z);
+    }
+
+    g.cellSize = tileSize * 4.0f;
+    g.originX = minX;
+    g.originZ = minZ;
+    g.cellsX = std::max(1, (int)std::ceil((maxX - minX) / g.cellSize));
+    g.cellsZ = std::max(1, (int)std::ceil((maxZ - minZ) / g.cellSize));
+
+    //bucket every collider into each cell it overlaps. long wall runs land in several.
+    std::vector<std::vector<int>> buckets(g.cellsX * g.cellsZ);
+    for (size_t i = 0; i < entries.size(); i++) {
+        const BoundingBox& b = entries[i].box;
+        int cx0 = std::clamp((int)std::floor((b.min.x - g.originX) / g.cellSize), 0, g.cellsX - 1);
+        int cx1 = std::clamp((int)std::floor((b.max.x - g.originX) / g.cellSize), 0, g.cellsX - 1);
+        int cz0 = std::clamp((int)std::floor((b.min.z - g.originZ) / g.cellSize), 0, g.cellsZ - 1);
+        int cz1 = std::clamp((int)std::floor((b.max.z - g.originZ) / g.cellSize), 0, g.cellsZ - 1);
+        for (int cz = cz0; cz <= cz1; cz++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                buckets[cz * g.cellsX + cx].push_back((int)i);
+            }
+        }
+    }
+
+    g.cellStart.resize(buckets.size());
+    g.cellEnd.resize(buckets.size());
+    g.cellLayers.assign(buckets.size(), LAYER_NONE);
+    gStaticColliders.Reserve(entries.size() * 2);
+
+    for (size_t c = 0; c < buckets.size(); c++) {
+        g.cellStart[c] = (uint32_t)gStaticColliders.Size();
+        for (int i : buckets[c]) {
+            const StaticEntry& e = entries[i];
+            gStaticColliders.Push(e.box, e.kind, e.owner, 0.0f, LAYER_STATIC, e.mask);
+            g.cellLayers[c] |= LAYER_STATIC;
+        }
+        gStaticColliders.Pad();
+        g.cellEnd[c] = (uint32_t)gStaticColliders.Size();
+    }
+}
+
+void ClearStaticColliders() {
+    gStaticColliders.Clear();
+    gStaticGrid.Clear();
+}
+
+void BuildDynamicColliders() {
+    //everything that can move, open, or break. cheap to rebuild, there are only a few dozen.
+    //state changes (dead, open, destroyed) just switch the layer off instead of dropping the collider.
+    ColliderSoA& s = gDynamicColliders;
+    s.Clear();
+
+    s.Push(player.GetBoundingBox(), ColliderKind::Player, 0, 1.0f, LAYER_PLAYER, LAYER_ENEMY_PROJECTILE | LAYER_ENEMY);
+
+    for (size_t i = 0; i < enemyPtrs.size(); i++) {
+        const Character* enemy = enemyPtrs[i];
+        uint32_t mask = LAYER_PLAYER_PROJECTILE | LAYER_CHARACTERS;
+        if (enemy->type == CharacterType::Skeleton) mask |= LAYER_ENEMY_PROJECTILE; // friendly fire
+        s.Push(enemy->GetBoundingBox(), ColliderKind::Enemy, (int)i, 1.0f,
+               enemy->isDead ? LAYER_NONE : LAYER_ENEMY, mask);
+    }
+
+    for (size_t i = 0; i < doors.size(); i++) {
+        const Door& d = doors[i];
+        s.Push(d.collider, ColliderKind::Door, (int)i, 0.0f, d.isOpen ? LAYER_NONE : LAYER_STATIC, kStaticMask);
+        for (size_t j = 0; j < d.sideColliders.size(); j++) {
+            s.Push(d.sideColliders[j], ColliderKind::DoorSide, (int)i, 0.0f,
+                   d.isOpen ? LAYER_STATIC : LAYER_NONE, kStaticMask, (int)j);
+        }
+    }
+
+    for (size_t i = 0; i < spiderWebs.size(); i++) {
+        s.Push(spiderWebs[i].bounds, ColliderKind::Web, (int)i, 1.0f,
+               spiderWebs[i].destroyed ? LAYER_NONE : LAYER_DESTRUCTIBLE, LAYER_PROJECTILES | LAYER_PLAYER);
+    }
+
+    for (size_t i = 0; i < barrelInstances.size(); i++) {
+        s.Push(barrelInstances[i].bounds, ColliderKind::Barrel, (int)i, 1.0f,
+               barrelInstances[i].destroyed ? LAYER_NONE : LAYER_DESTRUCTIBLE, LAYER_PROJECTILES | LAYER_CHARACTERS);
+    }
+
+    s.Pad();
+}
+
+// Same math as CheckCollisionBoxSphere: squared distance from the sphere center to the box, <= r^2.
+// Bullets scale r by radiusScale, so radius 0 is CheckCollisionPointBox (inclusive edges).
+// solid bodies (characters) always use their full radius.
+void SphereVsBoxes(const ColliderSoA& set, size_t begin, size_t end,
+                   float px, float py, float pz, float radius, bool solid,
+                   uint32_t bodyLayer, uint32_t bodyMask, std::vector<int>& outHits) {
+    const float r2 = radius * radius;
+
+#if defined(COLLISION_SSE2)
+    const __m128 vx = _mm_set1_ps(px);
+    const __m128 vy = _mm_set1_ps(py);
+    const __m128 vz = _mm_set1_ps(pz);
+    const __m128 vr2 = _mm_set1_ps(r2);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128i vBodyLayer = _mm_set1_epi32((int)bodyLayer);
+    const __m128i vBodyMask = _mm_set1_epi32((int)bodyMask);
+    const __m128i izero = _mm_setzero_si128();
+
+    for (size_t i = begin; i < end; i += 4) {
+        // layer/mask filter first, skip the geometry when no lane cares about this body
+        __m128i layerHit = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i*)&set.layer[i]), vBodyMask), izero);
+        __m128i maskHit = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i*)&set.mask[i]), vBodyLayer), izero);
+        int relevant = ~_mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(layerHit, maskHit))) & 0xF;
+        if (!relevant) continue;
+
+        __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&set.minX[i]), vx), _mm_sub_ps(vx, _mm_loadu_ps(&set.maxX[i]))), zero);
+        __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&set.minY[i]), vy), _mm_sub_ps(vy, _mm_loadu_ps(&set.maxY[i]))), zero);
+        __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&set.minZ[i]), vz), _mm_sub_ps(vz, _mm_loadu_ps(&set.maxZ[i]))), zero);
+
+        __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        __m128 limit = solid ? vr2 : _mm_mul_ps(vr2, _mm_loadu_ps(&set.radiusScale[i]));
+
+        int mask = _mm_movemask_ps(_mm_cmple_ps(d2, limit)) & relevant;
+        while (mask) {
+            int bit = __builtin_ctz(mask);
+            outHits.push_back((int)i + bit);
+            mask &= mask - 1;
+        }
+    }
+#else
+    for (size_t i = begin; i < end; i++) {
+        if (!LayersInteract(bodyLayer, bodyMask, set.layer[i], set.mask[i])) continue;
+        float dx = std::max(std::max(set.minX[i] - px, px - set.maxX[i]), 0.0f);
+        float dy = std::max(std::max(set.minY[i] - py, py - set.maxY[i]), 0.0f);
+        float dz = std::max(std::max(set.minZ[i] - pz, pz - set.maxZ[i]), 0.0f);
+        float limit = solid ? r2 : r2 * set.radiusScale[i];
+        if (dx*dx + dy*dy + dz*dz <= limit) outHits.push_back((int)i);
+    }
+#endif
+}
+
+// Walks the grid cells of the static set the sphere touches, then the whole dynamic set,
+// and hands every accepted overlap to emit(set, index).
+template <typename Fn>
+static void QueryCandidates(float px, float py, float pz, float radius, bool solid,
+                            uint32_t bodyLayer, uint32_t bodyMask, Fn&& emit) {
+    static std::vector<int> scratch;
+
+    const ColliderGrid& g = gStaticGrid;
+    if (gStaticColliders.count > 0 && (bodyMask & LAYER_STATIC)) {
+        int cx0 = (int)std::floor((px - radius - g.originX) / g.cellSize);
+        int cx1 = (int)std::floor((px + radius - g.originX) / g.cellSize);
+        int cz0 = (int)std::floor((pz - radius - g.originZ) / g.cellSize);
+        int cz1 = (int)std::floor((pz + radius - g.originZ) / g.cellSize);
+
+        if (cx1 >= 0 && cz1 >= 0 && cx0 < g.cellsX && cz0 < g.cellsZ) {
+            cx0 = std::max(cx0, 0); cx1 = std::min(cx1, g.cellsX - 1);
+            cz0 = std::max(cz0, 0); cz1 = std::min(cz1, g.cellsZ - 1);
+
+            for (int cz = cz0; cz <= cz1; cz++) {
+                for (int cx = cx0; cx <= cx1; cx++) {
+                    int c = cz * g.cellsX + cx;
+                    if ((g.cellLayers[c] & bodyMask) == 0) continue;
+                    scratch.clear();
+                    SphereVsBoxes(gStaticColliders, g.cellStart[c], g.cellEnd[c], px, py, pz, radius, solid, bodyLayer, bodyMask, scratch);
+                    for (int i : scratch) emit(gStaticColliders, i);
+                }
+            }
+        }
+    }
+
+    if (gDynamicColliders.count > 0) {
+        scratch.clear();
+        SphereVsBoxes(gDynamicColliders, 0, gDynamicColliders.Size(), px, py, pz, radius, solid, bodyLayer, bodyMask, scratch);
+        for (int i : scratch) emit(gDynamicColliders, i);
+    }
+}
+
+void QuerySphere(float px, float py, float pz, float radius, uint32_t bodyLayer, uint32_t bodyMask,
+                 std::vector<BulletHit>& outHits, int bodyIndex) {
+    QueryCandidates(px, py, pz, radius, false, bodyLayer, bodyMask, [&](const ColliderSoA& set, int i) {
+        outHits.push_back({ bodyIndex, set.kind[i], set.owner[i], set.sub[i] });
+    });
+}
+
+void QueryContacts(Vector3 center, float radius, uint32_t bodyLayer, uint32_t bodyMask, std::vector<ContactBox>& outContacts) {
+    outContacts.clear();
+    QueryCandidates(center.x, center.y, center.z, radius, true, bodyLayer, bodyMask, [&](const ColliderSoA& set, int i) {
+        BoundingBox box = { { set.minX[i], set.minY[i], set.minZ[i] }, { set.maxX[i], set.maxY[i], set.maxZ[i] } };
+        outContacts.push_back({ box, set.kind[i], set.owner[i], set.sub[i] });
+    });
+
+    // same ordering as the bullet hits, and drop grid duplicates
+    auto key = [](const ContactBox& c) { return std::make_tuple(c.kind, c.owner, c.sub); };
+    std::sort(outContacts.begin(), outContacts.end(), [&](const ContactBox& a, const ContactBox& b) { return key(a) < key(b); });
+    outContacts.erase(std::unique(outContacts.begin(), outContacts.end(), [&](const ContactBox& a, const ContactBox& b) { return key(a) == key(b); }), outContacts.end());
+}
+
+void CollectBulletHits(const BulletSoA& bullets, std::vector<BulletHit>& hits) {
+    hits.clear();
+
+    for (size_t b = 0; b < bullets.Size(); b++) {
+        QuerySphere(bullets.px[b], bullets.py[b], bullets.pz[b], bullets.r[b],
+                    bullets.layer[b], bullets.mask[b], hits, bullets.index[b]);
+    }
+
+    // static and dynamic sets interleave kinds, put them back in resolution order.
+    // owner order within a kind matches the order the old loops visited them.
+    // grid cells duplicate colliders that straddle them, drop the repeats.
+    auto key = [](const BulletHit& h) { return std::make_tuple(h.bullet, h.kind, h.owner, h.sub); };
+    std::sort(hits.begin(), hits.end(), [&](const BulletHit& a, const BulletHit& b) { return key(a) < key(b); });
+    hits.erase(std::unique(hits.begin(), hits.end(), [&](const BulletHit& a, const BulletHit& b) { return key(a) == key(b); }), hits.end());
+}
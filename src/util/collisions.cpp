@@ -4,6 +4,8 @@
 #include "util/sound_manager.h"
 #include "util/resourceManager.h"
 #include "char/pathfinding.h"
+#include "util/collisionWorld.h"
+#include "render/lighting.h"
 
 bool CheckCollisionPointBox(Vector3 point, BoundingBox box) {
     return (
@@ -36,209 +38,140 @@ void ResolveBoxSphereCollision(const BoundingBox& box, Vector3& position, float
     }
 }
 
-Vector3 ComputeOverlapVector(BoundingBox a, BoundingBox b) {
-    float xOverlap = fmin(a.max.x, b.max.x) - fmax(a.min.x, b.min.x);
-    float yOverlap = fmin(a.max.y, b.max.y) - fmax(a.min.y, b.min.y);
-    float zOverlap = fmin(a.max.z, b.max.z) - fmax(a.min.z, b.min.z);
-
-    if (xOverlap <= 0 || yOverlap <= 0 || zOverlap <= 0) {
-        return {0, 0, 0}; // No collision
-    }
-
-    float minOverlap = xOverlap;
-    Vector3 axis = {1, 0, 0};
-    if (yOverlap < minOverlap) {
-        minOverlap = yOverlap;
-        axis = {0, 1, 0};
-    }
-    if (zOverlap < minOverlap) {
-        minOverlap = zOverlap;
-        axis = {0, 0, 1};
-    }
-
-    // Get direction from a to b to know which way to push
-    Vector3 direction = Vector3Normalize(Vector3Subtract(b.min, a.min));
-    float sign = (Vector3DotProduct(axis, direction) >= 0) ? 1.0f : -1.0f;
-
-    return Vector3Scale(axis, minOverlap * sign);
+static bool IsAOE(const Bullet& b) {
+    return (b.type == BulletType::Fireball || b.type == BulletType::Iceball);
 }
 
-
-void ResolvePlayerEnemyMutualCollision(Character* enemy, Player* player) {
-    BoundingBox enemyBox = enemy->GetBoundingBox();
-    BoundingBox playerBox = player->GetBoundingBox();
-
-    Vector3 overlap = ComputeOverlapVector(enemyBox, playerBox);
-    if (Vector3Length(overlap) > 0) {
-        Vector3 correction = Vector3Scale(overlap, 0.5f);
-        enemy->position = Vector3Subtract(enemy->position, correction);
-        player->position = Vector3Add(player->position, correction);
-    }
+// bullet hit something solid. magic explodes, everything else dies with a smoke puff
+static void BulletHitWorld(Bullet& b, Camera& camera) {
+    if (IsAOE(b)) b.Explode(camera);
+    else          b.kill(camera);
 }
 
-// returns true if a regular (non-AoE) bullet should stop after this pass
-bool HandleBarrelHitsForBullet(Bullet& b, Camera& camera) {
-    const bool isAOE = (b.type == BulletType::Fireball || b.type == BulletType::Iceball);
-    bool hitAnything = false;
-
-
-    for (BarrelInstance& barrel : barrelInstances) {
-        if (barrel.destroyed) continue;
-
-        if (CheckCollisionBoxSphere(barrel.bounds, b.GetPosition(), b.GetRadius())) {
-            hitAnything = true;
-
-            // Mark and open the tile
-            barrel.destroyed = true;
-            int tileX = GetDungeonImageX(barrel.position.x, tileSize, dungeonWidth);
-            int tileY = GetDungeonImageY(barrel.position.z, tileSize, dungeonHeight);
-
-            if (tileX >= 0 && tileX < dungeonWidth &&
-                tileY >= 0 && tileY < dungeonHeight)
-            {
-                if (!walkable[tileX][tileY]) {
-                    walkable[tileX][tileY] = true;
-                }
-            }
-
-
-
-            // Play SFX
-            SoundManager::Get().Play("barrelBreak");
-
-
-            Vector3 dropPos{ barrel.position.x, barrel.position.y + 100.0f, barrel.position.z };
-            if (barrel.containsPotion) {
-                collectables.emplace_back(CollectableType::HealthPotion, dropPos, ResourceManager::Get().GetTexture("healthPotTexture"), 40);
-            } else if (barrel.containsMana) {
-                collectables.emplace_back(CollectableType::ManaPotion, dropPos, ResourceManager::Get().GetTexture("manaPotion"), 40);
-            } else if (barrel.containsGold) {
-                Collectable gold(CollectableType::Gold, dropPos, ResourceManager::Get().GetTexture("coinTexture"), 40);
-                gold.value = GetRandomValue(1, 100);
-                collectables.push_back(gold);
-            }
-            // For non-AoE bullets, stop after the first hit this frame
-            if (!isAOE) break;
+static void BreakBarrel(BarrelInstance& barrel) {
+    // Mark and open the tile
+    barrel.destroyed = true;
+    RebakeLightsAround(barrel.bounds); // no longer casts a shadow
+    int tileX = GetDungeonImageX(barrel.position.x, tileSize, dungeonWidth);
+    int tileY = GetDungeonImageY(barrel.position.z, tileSize, dungeonHeight);
+
+    if (tileX >= 0 && tileX < dungeonWidth &&
+        tileY >= 0 && tileY < dungeonHeight)
+    {
+        if (!walkable[tileX][tileY]) {
+            walkable[tileX][tileY] = true;
         }
     }
 
-    // After processing all overlaps, resolve the bullet
-    if (hitAnything) {
-        if (isAOE) b.Explode(camera);
-        else       b.kill(camera);
+    // Play SFX
+    SoundManager::Get().Play("barrelBreak");
+
+    Vector3 dropPos{ barrel.position.x, barrel.position.y + 100.0f, barrel.position.z };
+    if (barrel.containsPotion) {
+        collectables.emplace_back(CollectableType::HealthPotion, dropPos, ResourceManager::Get().GetTexture("healthPotTexture"), 40);
+    } else if (barrel.containsMana) {
+        collectables.emplace_back(CollectableType::ManaPotion, dropPos, ResourceManager::Get().GetTexture("manaPotion"), 40);
+    } else if (barrel.containsGold) {
+        Collectable gold(CollectableType::Gold, dropPos, ResourceManager::Get().GetTexture("coinTexture"), 40);
+        gold.value = GetRandomValue(1, 100);
+        collectables.push_back(gold);
     }
-
-    // Tell caller whether to stop iterating this bullet
-    return hitAnything && !isAOE;
 }
 
-void launcherCollision(){
-    for (LauncherTrap& launcher : launchers){
-        if (CheckCollisionBoxSphere(launcher.bounds, player.position, player.radius)){
-            ResolveBoxSphereCollision(launcher.bounds, player.position, player.radius);
-        }
-    }
-}
+// Characters are vertical capsules, a segment from bottomY to topY swept by radius.
+// Returns how far to move the capsule to get it out of the box, or zero if they don't touch.
+// Where the segment spans the box vertically the push is flat in XZ, so wall corners never
+// shove a character up or down.
+static Vector3 CapsuleBoxPush(const BoundingBox& box, Vector3 position, float bottomY, float topY, float radius) {
+    // point on the segment closest to the box's Y range
+    float segY;
+    if (box.max.y < bottomY)   segY = bottomY;
+    else if (box.min.y > topY) segY = topY;
+    else                       segY = fmax(bottomY, box.min.y);
+
+    Vector3 p = { position.x, segY, position.z };
+    Vector3 closest = {
+        Clamp(p.x, box.min.x, box.max.x),
+        Clamp(p.y, box.min.y, box.max.y),
+        Clamp(p.z, box.min.z, box.max.z)
+    };
 
+    Vector3 pushDir = Vector3Subtract(p, closest);
+    float distance = Vector3Length(pushDir);
 
-void SpiderWebCollision(){
-    for (SpiderWebInstance& web : spiderWebs){
-        if (!web.destroyed && CheckCollisionBoxSphere(web.bounds, player.position, player.radius)){
-            ResolveBoxSphereCollision(web.bounds, player.position, player.radius);
-        }
+    if (distance == 0.0f) {
+        // segment is inside the box, leave by the shortest way out in XZ
+        float left  = p.x - box.min.x, right = box.max.x - p.x;
+        float back  = p.z - box.min.z, front = box.max.z - p.z;
+        float best = fmin(fmin(left, right), fmin(back, front));
+        if (best == left)       return { -(left + radius), 0, 0 };
+        else if (best == right) return { right + radius, 0, 0 };
+        else if (best == back)  return { 0, 0, -(back + radius) };
+        else                    return { 0, 0, front + radius };
     }
-}
-
-
-void DoorCollision(){
-    for (Door& door : doors){//player collision
-        if (!door.isOpen && CheckCollisionBoxSphere(door.collider, player.position, player.radius)){
-           ResolveBoxSphereCollision(door.collider, player.position, player.radius);
 
-        }
-
-        for (Character* enemy : enemyPtrs){ //enemy collilsion 
-            if (!door.isOpen && CheckCollisionBoxSphere(door.collider, enemy->position, enemy->radius)){
-                ResolveBoxSphereCollision(door.collider, enemy->position, enemy->radius);
-            }
-        }
-        
-        //door side colliders
-        for (BoundingBox& side : door.sideColliders){
-            if (door.isOpen && CheckCollisionBoxSphere(side, player.position, 100)){
-                ResolveBoxSphereCollision(side, player.position, 100);
-            }
-
-            for (Character* enemy : enemyPtrs){
-                if (door.isOpen && CheckCollisionBoxSphere(side, enemy->position, enemy->radius)){
-                    ResolveBoxSphereCollision(side, enemy->position, enemy->radius);
-                }
-            }
-        }
-
-    }
+    float overlap = radius - distance;
+    if (overlap <= 0.0f) return { 0, 0, 0 };
+    return Vector3Scale(pushDir, overlap / distance);
 }
 
-void WallCollision(){
-    for (const WallRun& run : wallRunColliders) { //player wall collision
-
-        for (Character* enemy : enemyPtrs){ //all enemies
-            if (CheckCollisionBoxSphere(run.bounds, enemy->position, enemy->radius)){
-                ResolveBoxSphereCollision(run.bounds, enemy->position, enemy->radius);
+static constexpr int   kCharacterIterations = 3;      // fixed relaxation passes over the gathered contacts
+static constexpr float kContactSkin = 25.0f;          // gather a little past the radius so pushes can't walk into unseen boxes
+static constexpr float kPlayerArchwayRadius = 100.0f; // tighter than player.radius so the player fits through open doorways
+static constexpr float kPlayerBodyHalfWidth = 20.0f;  // matches Player::GetBoundingBox, used against enemies
+
+// Gathers every contact for one character in a single broadphase query, then relaxes them
+// a fixed number of times. Player vs enemy pairs split the push between both.
+static void ResolveCharacter(Vector3& position, float radius, float height, bool isPlayer, std::vector<ContactBox>& contacts) {
+    uint32_t layer = isPlayer ? LAYER_PLAYER : LAYER_ENEMY;
+    uint32_t mask  = LAYER_STATIC | LAYER_DESTRUCTIBLE;
+    if (isPlayer) mask |= LAYER_ENEMY; // enemy vs player is handled from the player's side only
+
+    Vector3 center = { position.x, position.y + height * 0.5f, position.z };
+    QueryContacts(center, radius + height * 0.5f + kContactSkin, layer, mask, contacts);
+    if (contacts.empty()) return;
+
+    for (int iter = 0; iter < kCharacterIterations; iter++) {
+        bool moved = false;
+
+        for (const ContactBox& c : contacts) {
+            if (c.kind == ColliderKind::Enemy) {
+                Character* enemy = enemyPtrs[c.owner];
+                Vector3 push = CapsuleBoxPush(enemy->GetBoundingBox(), position,
+                                              position.y - 30.0f, position.y + 30.0f, kPlayerBodyHalfWidth);
+                if (push.x == 0.0f && push.z == 0.0f && push.y == 0.0f) continue;
+                Vector3 half = Vector3Scale(push, 0.5f);
+                position = Vector3Add(position, half);
+                enemy->position = Vector3Subtract(enemy->position, half);
+                moved = true;
+                continue;
             }
-        }
 
-        if (CheckCollisionBoxSphere(run.bounds, player.position, player.radius)) { //player wall collision
-            ResolveBoxSphereCollision(run.bounds, player.position, player.radius);
+            float r = (isPlayer && c.kind == ColliderKind::DoorSide) ? kPlayerArchwayRadius : radius;
+            Vector3 push = CapsuleBoxPush(c.box, position, position.y, position.y + height, r);
+            if (push.x == 0.0f && push.z == 0.0f && push.y == 0.0f) continue;
+            position = Vector3Add(position, push);
+            moved = true;
         }
 
+        if (!moved) break;
     }
 }
 
-void pillarCollision() {
-    for (const PillarInstance& pillar : pillars){
-        ResolveBoxSphereCollision(pillar.bounds, player.position, player.radius);
-        for (Character* enemy : enemyPtrs){
-            ResolveBoxSphereCollision(pillar.bounds, enemy->position, enemy->radius);
-        }
-    }
-
-
-}
+void ResolveCharacterCollisions() {
+    // bullets may have broken barrels or torn webs this tick, and characters moved. rebuild first.
+    BuildDynamicColliders();
 
-void barrelCollision(){
-    
-    for (const BarrelInstance& barrel : barrelInstances) {
-        if (!barrel.destroyed){ //walk through broke barrels
-            ResolveBoxSphereCollision(barrel.bounds, player.position, player.radius);
-            for (Character* enemy : enemyPtrs){
-                ResolveBoxSphereCollision(barrel.bounds, enemy->position, enemy->radius);
-            }
-        }
-        
-    }
+    static std::vector<ContactBox> contacts;
 
-}
+    ResolveCharacter(player.position, player.radius, player.height * 0.5f, true, contacts);
 
-void ChestCollision(){
-    for (const ChestInstance& chest : chestInstances){
-        ResolveBoxSphereCollision(chest.bounds, player.position, player.radius);
-        for (Character* enemy : enemyPtrs){
-            ResolveBoxSphereCollision(chest.bounds, enemy->position, enemy->radius);
-        }
-    }
-}
-
-void HandleEnemyPlayerCollision(Player* player) {
     for (Character* enemy : enemyPtrs) {
-        if (enemy->isDead) continue;
-        if (CheckCollisionBoxes(enemy->GetBoundingBox(), player->GetBoundingBox())) {
-            ResolvePlayerEnemyMutualCollision(enemy, player);
-        }
+        if (enemy->isDead) continue; // corpses don't move, nothing new to push out of
+        ResolveCharacter(enemy->position, enemy->radius, enemy->radius, false, contacts);
     }
 }
 
-
 void HandleMeleeHitboxCollision(Camera& camera) {
 
     for (BarrelInstance& barrel : barrelInstances){
@@ -249,6 +182,7 @@ void HandleMeleeHitboxCollision(Camera& camera) {
         if (CheckCollisionBoxes(barrel.bounds, player.meleeHitbox)){
             PlayerSwipeDecal(camera); //swipe decal on hit. 
             barrel.destroyed = true;
+            RebakeLightsAround(barrel.bounds);
             walkable[tileX][tileY] = true; //tile is now walkable for enemies
             SoundManager::Get().Play("barrelBreak");
             if (barrel.containsPotion) {
@@ -313,158 +247,135 @@ void HandleMeleeHitboxCollision(Camera& camera) {
 
 }
 
-void CheckBulletHits(Camera& camera) {
-    
-    for (Bullet& b : activeBullets) {
-        if (!b.IsAlive()) continue;
-
-        Vector3 pos = b.GetPosition();
-
-        // 🔹 1. Hit player
-        if (CheckCollisionBoxSphere(player.GetBoundingBox(), b.GetPosition(), b.GetRadius())) { //use CollisionBoxSphere and use bullet radius
-            if (b.type == BulletType::Fireball){
-                b.Explode(camera);
-                //damage delt elseware
-                continue;
-            }
-            if (b.IsEnemy()) {
-                //b.kill(camera);
+// Applies every hit one bullet collected this frame. hits arrive in ColliderKind order,
+// player -> enemies -> walls -> doors -> pillars -> webs -> barrels.
+// state is re-checked here because an earlier bullet may already have killed the enemy or broken the barrel.
+static void ResolveBulletHits(Bullet& b, const BulletHit* first, const BulletHit* last, Camera& camera) {
+    bool webHit = false;
+    bool barrelHit = false;
+
+    for (const BulletHit* h = first; h != last; ++h) {
+        if (!b.IsAlive()) return;
+
+        switch (h->kind) {
+            // 🔹 1. Hit player
+            // only enemy projectiles get here, the player's mask filters out our own shots
+            case ColliderKind::Player:
+                if (b.type == BulletType::Fireball){
+                    b.Explode(camera);
+                    //damage delt elseware
+                    return;
+                }
                 b.BulletHole(camera);
                 player.TakeDamage(25);
-                continue;
-            }
-        }
+                return;
+
+            // 🔹 2. Hit enemy
+            // enemy projectiles only get here for skeletons (friendly fire is in the skeleton's mask)
+            case ColliderKind::Enemy: {
+                Character* enemy = enemyPtrs[h->owner];
+                if (enemy->isDead) break; // killed by an earlier bullet this frame
 
-        // 🔹 2. Hit enemy
-        for (Character* enemy : enemyPtrs) {
-            if (enemy->isDead) continue;
-            bool isSkeleton = (enemy->type == CharacterType::Skeleton);
-            if (CheckCollisionBoxSphere(enemy->GetBoundingBox(), b.GetPosition(), b.GetRadius())) {
-                if (!b.IsEnemy() && (b.type == BulletType::Default)) {
+                if (b.IsEnemy()) { // friendly fire
                     enemy->TakeDamage(25);
-                    if (enemy->isDead){
-                        if (enemy->type == CharacterType::Skeleton || enemy->type == CharacterType::Ghost){
-                            b.Erase();
-                            break;
-
-                        }else{
-                            b.Blood(camera); //blood decal on death
-                            b.Erase();
-                            break;
-                            //b.Erase();
-                        }
-                    }
+                    b.kill(camera);
 
-                    //b.BulletHole(camera, true);
+                } else if (b.type == BulletType::Default) {
+                    enemy->TakeDamage(25);
+                    if (enemy->isDead && enemy->type != CharacterType::Skeleton && enemy->type != CharacterType::Ghost){
+                        b.Blood(camera); //blood decal on death
+                    }
                     b.Erase();
-                    break;
 
-                }
-                
-                else if (!b.IsEnemy() && (b.type == BulletType::Fireball)){
+                } else if (b.type == BulletType::Fireball){
                     enemy->TakeDamage(25);
-                    
                     b.pendingExplosion = true;
-                    b.explosionTimer = 0.04f; // short delay //so it blows up inside the enemy not on the top of their head. 
+                    b.explosionTimer = 0.04f; // short delay //so it blows up inside the enemy not on the top of their head.
                     // Don't call b.Explode() yet //called in updateFireball
 
-                }else if (!b.IsEnemy() && (b.type == BulletType::Iceball)){
-                    //enemy->TakeDamage(25);
+                } else if (b.type == BulletType::Iceball){
                     enemy->ChangeState(CharacterState::Freeze);
                     b.pendingExplosion = true;
                     b.explosionTimer = 0.04f;
-
-                    
-                } else if (b.IsEnemy() && isSkeleton) { // friendly fire
-                    enemy->TakeDamage(25);
-                    b.kill(camera);
-                    break;
                 }
-
-                
+                break;
             }
-        }
-
-
-
-        // 🔹 3. Hit walls
-        for (WallRun& w : wallRunColliders) {
-            if (CheckCollisionPointBox(pos, w.bounds)) {
-                if (b.type == BulletType::Fireball || b.type == BulletType::Iceball){
-                    b.Explode(camera);
-                    break;
-                }else{
-                    b.kill(camera);
-                    break;
-
-                }
 
+            // 🔹 3. Hit walls, doors, archway sides and pillars
+            case ColliderKind::Wall:
+            case ColliderKind::Door:
+            case ColliderKind::DoorSide:
+            case ColliderKind::Pillar:
+                BulletHitWorld(b, camera);
+                break;
+
+            // 🔹 4. Hit spiderweb, one per frame
+            case ColliderKind::Web: {
+                SpiderWebInstance& web = spiderWebs[h->owner];
+                if (webHit || web.destroyed) break; // torn by an earlier bullet this frame
+                web.destroyed = true;
+                webHit = true;
+                BulletHitWorld(b, camera);
+                break;
             }
-        }
 
-        // 🔹 4. Hit doors
-        for (Door& d : doors) {
-            if (!d.isOpen && CheckCollisionPointBox(pos, d.collider)) {
-                if (b.type == BulletType::Fireball || b.type == BulletType::Iceball){
-                    b.Explode(camera);
-                    break;
-                }else{
+            // 🔹 5. Hit barrels. AoE breaks every barrel it touches, regular bullets stop at the first
+            case ColliderKind::Barrel: {
+                BarrelInstance& barrel = barrelInstances[h->owner];
+                if (barrel.destroyed) break; // broken by an earlier bullet this frame
+                BreakBarrel(barrel);
+                barrelHit = true;
+                if (!IsAOE(b)) {
                     b.kill(camera);
-                    break;
-
+                    return;
                 }
+                break;
             }
-            //archway side colliders
-            for (BoundingBox& side : d.sideColliders){
-                if (d.isOpen && CheckCollisionPointBox(pos, side)){
-                    if (b.type == BulletType::Fireball || b.type == BulletType::Iceball){
-                        b.Explode(camera);
-                        break;
-                    }else{
-                        b.kill(camera);
-                        break;
 
-                    }
-                }
-            }
+            // masks keep bullets off these, listed so the switch stays exhaustive
+            case ColliderKind::Chest:
+            case ColliderKind::Launcher:
+                break;
         }
+    }
 
+    if (barrelHit) b.Explode(camera);
+}
 
+void CheckBulletHits(Camera& camera) {
+    // batched: snapshot live bullets into SoA, test them all against the collider sets,
+    // then resolve the hits in a separate pass.
+    static std::vector<Bullet*> liveBullets;
+    static BulletSoA bulletSoA;
+    static std::vector<BulletHit> hits;
 
-        // 🔹 6. Hit pillars
-        for (PillarInstance& pillar : pillars) {
-            if (CheckCollisionPointBox(pos, pillar.bounds)) {
-                if (b.type == BulletType::Fireball || b.type == BulletType::Iceball){
-                    b.Explode(camera);
-                    break;
-                }else{
-                    b.kill(camera);
-                    break;
-
-                }
-            }
-        }
-        //Hit spiderweb
-        for (SpiderWebInstance& web : spiderWebs){
-            if (!web.destroyed && CheckCollisionBoxSphere(web.bounds, b.GetPosition(), b.GetRadius())){
-                web.destroyed = true;
-                if (b.type == BulletType::Fireball || b.type == BulletType::Iceball){
-                    b.Explode(camera);
-                    break;
-                }else{
-                    b.kill(camera);
-                    break;
+    liveBullets.clear();
+    bulletSoA.Clear();
 
-                }
-            }
-        }
+    for (Bullet& b : activeBullets) {
+        if (!b.IsAlive()) continue;
+        Vector3 pos = b.GetPosition();
+        bulletSoA.px.push_back(pos.x);
+        bulletSoA.py.push_back(pos.y);
+        bulletSoA.pz.push_back(pos.z);
+        bulletSoA.r.push_back(b.GetRadius());
+        bulletSoA.layer.push_back(b.collisionLayer);
+        bulletSoA.mask.push_back(b.collisionMask);
+        bulletSoA.index.push_back((int)liveBullets.size());
+        liveBullets.push_back(&b);
+    }
 
-                            // bullet hits barrel
-        if (HandleBarrelHitsForBullet(b, camera)){
-            break; //check bullets last
-        }
+    if (liveBullets.empty()) return;
 
+    BuildDynamicColliders();
+    CollectBulletHits(bulletSoA, hits);
 
+    size_t h = 0;
+    while (h < hits.size()) {
+        size_t end = h;
+        while (end < hits.size() && hits[end].bullet == hits[h].bullet) end++;
+        ResolveBulletHits(*liveBullets[hits[h].bullet], &hits[h], hits.data() + end, camera);
+        h = end;
     }
 }
 
@@ -664,6 +575,7 @@ void HandleDoorInteraction() {
         if (openTimer >= 0.5f && pendingDoorIndex != -1) {
             doors[pendingDoorIndex].isOpen = !doors[pendingDoorIndex].isOpen;
             doorways[pendingDoorIndex].isOpen = doors[pendingDoorIndex].isOpen;
+            RebakeLightsAround(doors[pendingDoorIndex].collider); // light through (or no longer through) the doorway
 
             // Update walkable grid, open doors are walkable. 
             int tileX = GetDungeonImageX(doors[pendingDoorIndex].position.x, tileSize, dungeonWidth);
@@ -683,14 +595,7 @@ void HandleDoorInteraction() {
 void UpdateCollisions(Camera& camera){
     CheckBulletHits(camera); //bullet collision
     TreeCollision(camera); //player and raptor vs tree
-    WallCollision();
-    DoorCollision();
-    SpiderWebCollision();
-    barrelCollision();
-    ChestCollision();
-    HandleEnemyPlayerCollision(&player);
-    pillarCollision();
-    launcherCollision();
+    ResolveCharacterCollisions(); //player and enemies vs walls, doors, webs, barrels, chests, pillars, launchers and each other
     HandleMeleeHitboxCollision(camera);
 }
 
@@ -0,0 +1,91 @@
+#include "util/job_pool.h"
+
+#include <algorithm>
+
+JobPool& JobPool::Get() {
+    static JobPool instance;
+    return instance;
+}
+
+JobPool::JobPool() {
+    // leave one core for the main thread, it takes chunks too while it waits
+    unsigned hw = std::thread::hardware_concurrency();
+    unsigned count = hw > 1 ? hw - 1 : 0;
+    count = std::min(count, 7u);
+
+    for (unsigned i = 0; i < count; i++) {
+        workers.emplace_back(&JobPool::WorkerLoop, this);
+    }
+}
+
+JobPool::~JobPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) t.join();
+}
+
+// Grabs the next chunk of the current job and runs it. false when there's nothing left to grab.
+bool JobPool::RunOneChunk() {
+    size_t begin, end;
+    const std::function<void(size_t, size_t)>* fn;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!job || nextIndex >= jobCount) return false;
+        begin = nextIndex;
+        end = std::min(jobCount, begin + jobGrain);
+        nextIndex = end;
+        fn = job;
+    }
+
+    (*fn)(begin, end);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--chunksLeft == 0) done.notify_all();
+    }
+    return true;
+}
+
+void JobPool::WorkerLoop() {
+    unsigned seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return quitting || (generation != seen && job && nextIndex < jobCount); });
+            if (quitting) return;
+            seen = generation;
+        }
+        while (RunOneChunk()) {}
+    }
+}
+
+void JobPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+
+    // not worth waking anybody up
+    if (workers.empty() || count <= grain) {
+        fn(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        jobCount = count;
+        jobGrain = grain;
+        nextIndex = 0;
+        chunksLeft = (count + grain - 1) / grain;
+        generation++;
+    }
+    wake.notify_all();
+
+    while (RunOneChunk()) {}
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return chunksLeft == 0; });
+    job = nullptr;
+}
@@ -1,10 +1,14 @@
 #include "util/resourceManager.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
 #include <stdexcept>
 #include "world/world.h"
 #include "render/lighting.h"
+#include "render/dynamicResolution.h"
+#include "render/lightClusters.h"
+#include "render/spriteAtlas.h"
 
 // Constructors
 
@@ -154,12 +158,18 @@ void ResourceManager::LoadAllResources() {
     LoadShader("lightingShader","assets/shaders/lighting_baked_xz.vs", "assets/shaders/lighting_baked_xz.fs");
     LoadShader("lavaShader",    "assets/shaders/lava_world.vs",        "assets/shaders/lava_world.fs");
     LoadShader("treeShader", "assets/shaders/treeShader.vs",           "assets/shaders/treeShader.fs");
+    Shader& treeInstanced = LoadShader("treeShaderInstanced", "assets/shaders/treeShader_instanced.vs", "assets/shaders/treeShader.fs");
+    treeInstanced.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(treeInstanced, "instanceTransform"); // vegetation LOD batches
     LoadShader("portalShader", "assets/shaders/portal.vs",             "assets/shaders/portal.fs");
+
+    BuildSpriteAtlas(); // billboard sheets, needs their texture ids from above
 }
 
 // Unload functions
 
 void ResourceManager::UnloadAll() {
+    UnloadSpriteAtlas();
+
     for (auto& [_, texture] : textures) {
         UnloadTexture(texture);
     }
@@ -188,7 +198,9 @@ void ResourceManager::UnloadAll() {
 // Shader functions
 
 void ResourceManager::UpdateShaders(Camera& camera){
-    Vector2 screenResolution = (Vector2){ (float)GetScreenWidth(), (float)GetScreenHeight() };
+    //fog runs at the scene's (dynamic) resolution, its texel offsets need that size
+    const Texture2D& sceneTex = GetRenderTexture("sceneTexture").texture;
+    Vector2 sceneResolution = (Vector2){ (float)sceneTex.width, (float)sceneTex.height };
 
     Shader& waterShader = GetShader("waterShader");
     Shader& skyShader = GetShader("skyShader");
@@ -223,7 +235,7 @@ void ResourceManager::UpdateShaders(Camera& camera){
     float dungeonContrast = 1.00f; //makes darks darker. 
 
     int isDungeonVal = isDungeon ? 1 : 0;
-    SetShaderValue(fogShader, GetShaderLocation(fogShader, "resolution"), &screenResolution, SHADER_UNIFORM_VEC2);
+    SetShaderValue(fogShader, GetShaderLocation(fogShader, "resolution"), &sceneResolution, SHADER_UNIFORM_VEC2);
     SetShaderValue(fogShader, GetShaderLocation(fogShader, "isDungeon"), &isDungeonVal, SHADER_UNIFORM_INT);
     SetShaderValue(fogShader, GetShaderLocation(fogShader, "dungeonDarkness"), &dungeonDarkness, SHADER_UNIFORM_FLOAT);
     SetShaderValue(fogShader, GetShaderLocation(fogShader, "dungeonContrast"), &dungeonContrast, SHADER_UNIFORM_FLOAT);
@@ -254,6 +266,8 @@ void ResourceManager::UpdateShaders(Camera& camera){
 
     SetShaderValue(terrainShader, locCam_Terrain, &camPos, SHADER_UNIFORM_VEC3);
     SetShaderValue(treeShader,   locCam_Trees,   &camPos, SHADER_UNIFORM_VEC3);
+    Shader& treeInstanced = GetShader("treeShaderInstanced");
+    SetShaderValue(treeInstanced, GetShaderLocation(treeInstanced, "cameraPos"), &camPos, SHADER_UNIFORM_VEC3);
 
     int loc_time_p = GetShaderLocation(GetShader("portalShader"), "u_time");
     //portal
@@ -263,7 +277,9 @@ void ResourceManager::UpdateShaders(Camera& camera){
 void ResourceManager::SetBloomShaderValues(){
     //bloom post process. 
     Shader& bloomShader = GetShader("bloomShader");
-    Vector2 screenResolution = (Vector2){ (float)GetScreenWidth(), (float)GetScreenHeight() };
+    //bloom samples postProcessTexture, which is at the dynamic scene resolution, and upscales it
+    const Texture2D& postTex = GetRenderTexture("postProcessTexture").texture;
+    Vector2 sourceResolution = (Vector2){ (float)postTex.width, (float)postTex.height };
     bloomStrengthValue = 0.0f;
     float bloomColor[3] = { 1.0f, 1.0f, 1.0f };  
     float aaStrengthValue = 0.0f; //blur
@@ -283,7 +299,7 @@ void ResourceManager::SetBloomShaderValues(){
     SetShaderValue(bloomShader, GetShaderLocation(bloomShader, "uToneMapOperator"), &toneOp, SHADER_UNIFORM_INT);
 
     vignetteStrengthValue = 0.35f; //darker vignette in dungeons
-    SetShaderValue(bloomShader, GetShaderLocation(bloomShader, "resolution"), &screenResolution, SHADER_UNIFORM_VEC2);
+    SetShaderValue(bloomShader, GetShaderLocation(bloomShader, "resolution"), &sourceResolution, SHADER_UNIFORM_VEC2);
     SetShaderValue(bloomShader, GetShaderLocation(bloomShader, "vignetteStrength"), &vignetteStrengthValue, SHADER_UNIFORM_FLOAT);
     SetShaderValue(bloomShader, GetShaderLocation(bloomShader, "bloomStrength"), &bloomStrengthValue, SHADER_UNIFORM_FLOAT);
     SetShaderValue(bloomShader, GetShaderLocation(bloomShader, "bloomColor"), bloomColor, SHADER_UNIFORM_VEC3);
@@ -381,6 +397,8 @@ void ResourceManager::SetLightingShaderValues() {
     if (locAmb    >= 0) SetShaderValue(use, locAmb,    &ambientBoost, SHADER_UNIFORM_FLOAT);
 
     if (locDynTex >= 0) SetShaderValueTexture(use, locDynTex, gDynamic.tex);
+    SetLightmapPageShaderValues(use);
+    SetLightClusterShaderValues(use);
 
     // --- New lava/ceiling uniforms ---
     int locIsCeil   = GetShaderLocation(use, "isCeiling");        // int
@@ -420,9 +438,9 @@ void ResourceManager::SetTerrainShaderValues(){ //plus palm tree shader
     terrainShader.locs[SHADER_LOC_MAP_OCCLUSION]  = GetShaderLocation(terrainShader, "textureOcclusion");
 
     // Assign shader and maps to the terrain material
-    terrainModel.materials[0].shader = terrainShader;
-    SetMaterialTexture(&terrainModel.materials[0], MATERIAL_MAP_ALBEDO,    grassTex);
-    SetMaterialTexture(&terrainModel.materials[0], MATERIAL_MAP_METALNESS, sandTex);
+    terrainMaterial.shader = terrainShader;
+    SetMaterialTexture(&terrainMaterial, MATERIAL_MAP_ALBEDO,    grassTex);
+    SetMaterialTexture(&terrainMaterial, MATERIAL_MAP_METALNESS, sandTex);
 
     //terrain
     // Uniforms for world bounds & tiling
@@ -472,23 +490,26 @@ void ResourceManager::SetTerrainShaderValues(){ //plus palm tree shader
     Model& bushModel = GetModel("bush");
     Model& doorwayModel = GetModel("doorWayGray");
 
-    // Hook ALBEDO to our sampler name
-    treeShader.locs[SHADER_LOC_MAP_ALBEDO] = GetShaderLocation(treeShader, "textureDiffuse");
-
-    // (optional) hook diffuse tint if you plan to use it; otherwise raylib will handle it
-    treeShader.locs[SHADER_LOC_COLOR_DIFFUSE] = GetShaderLocation(treeShader, "colDiffuse");
-
-    // Set shared fog uniforms once (reuse the same values as terrain)
-    SetShaderValue(treeShader, GetShaderLocation(treeShader,"u_SkyColorTop"),      &skyTop,   SHADER_UNIFORM_VEC3);
-    SetShaderValue(treeShader, GetShaderLocation(treeShader,"u_SkyColorHorizon"),  &skyHorz,  SHADER_UNIFORM_VEC3);
-    SetShaderValue(treeShader, GetShaderLocation(treeShader,"u_FogStart"),         &fogStart, SHADER_UNIFORM_FLOAT);
-    SetShaderValue(treeShader, GetShaderLocation(treeShader,"u_FogEnd"),           &fogEnd,   SHADER_UNIFORM_FLOAT);
-    SetShaderValue(treeShader, GetShaderLocation(treeShader,"u_SeaLevel"),         &seaLevel, SHADER_UNIFORM_FLOAT);
-    SetShaderValue(treeShader, GetShaderLocation(treeShader,"u_FogHeightFalloff"), &falloff,  SHADER_UNIFORM_FLOAT);
-
-    // Alpha cutoff (tweak per asset)
-    float alphaCut = 0.30f;
-    SetShaderValue(treeShader, GetShaderLocation(treeShader,"alphaCutoff"), &alphaCut, SHADER_UNIFORM_FLOAT);
+    // Same setup on the instanced twin (vegetation LOD batches), it shares treeShader.fs
+    for (Shader use : { treeShader, GetShader("treeShaderInstanced") }) {
+        // Hook ALBEDO to our sampler name
+        use.locs[SHADER_LOC_MAP_ALBEDO] = GetShaderLocation(use, "textureDiffuse");
+
+        // (optional) hook diffuse tint if you plan to use it; otherwise raylib will handle it
+        use.locs[SHADER_LOC_COLOR_DIFFUSE] = GetShaderLocation(use, "colDiffuse");
+
+        // Set shared fog uniforms once (reuse the same values as terrain)
+        SetShaderValue(use, GetShaderLocation(use,"u_SkyColorTop"),      &skyTop,   SHADER_UNIFORM_VEC3);
+        SetShaderValue(use, GetShaderLocation(use,"u_SkyColorHorizon"),  &skyHorz,  SHADER_UNIFORM_VEC3);
+        SetShaderValue(use, GetShaderLocation(use,"u_FogStart"),         &fogStart, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(use, GetShaderLocation(use,"u_FogEnd"),           &fogEnd,   SHADER_UNIFORM_FLOAT);
+        SetShaderValue(use, GetShaderLocation(use,"u_SeaLevel"),         &seaLevel, SHADER_UNIFORM_FLOAT);
+        SetShaderValue(use, GetShaderLocation(use,"u_FogHeightFalloff"), &falloff,  SHADER_UNIFORM_FLOAT);
+
+        // Alpha cutoff (tweak per asset)
+        float alphaCut = 0.30f;
+        SetShaderValue(use, GetShaderLocation(use,"alphaCutoff"), &alphaCut, SHADER_UNIFORM_FLOAT);
+    }
 
     for (int i = 0; i < doorwayModel.materialCount; ++i) {
         doorwayModel.materials[i].shader = treeShader;
@@ -587,26 +608,27 @@ void ResourceManager::SetShaderValues(){
     SetShaderValue(bloomShader, locSat, &sat, SHADER_UNIFORM_FLOAT); 
 }
 
+// Scene targets follow the window size times the dynamic resolution scale. Called every frame, only
+// reallocates when that size changed.
 void ResourceManager::EnsureScreenSizedRTs() {
-    static int gLastW = -1, gLastH = -1;
-    int w = GetScreenWidth(), h = GetScreenHeight();
-    if (w == gLastW && h == gLastH) return;
-
-    // Recreate sceneTexture
-    if (renderTextures.count("sceneTexture")) {
-        UnloadRenderTexture(renderTextures["sceneTexture"]);
+    int w = std::max(1, (int)(GetScreenWidth() * GetRenderScale() + 0.5f));
+    int h = std::max(1, (int)(GetScreenHeight() * GetRenderScale() + 0.5f));
+    const Texture2D& current = GetRenderTexture("sceneTexture").texture;
+    if (current.width == w && current.height == h) return;
+
+    // Recreate sceneTexture and postProcessTexture, LoadRenderTexture would hand back the old entries
+    for (const char* name : { "sceneTexture", "postProcessTexture" }) {
+        RenderTexture2D& rt = renderTextures[name];
+        UnloadRenderTexture(rt);
+        rt = ::LoadRenderTexture(w, h);
+        SetTextureFilter(rt.texture, TEXTURE_FILTER_BILINEAR);
+        SetTextureWrap(rt.texture, TEXTURE_WRAP_CLAMP);
     }
-    renderTextures["sceneTexture"] = LoadRenderTexture("sceneTexture", w, h);
-    SetTextureWrap(renderTextures["sceneTexture"].texture, TEXTURE_WRAP_CLAMP);
 
-    // Recreate postProcessTexture
-    if (renderTextures.count("postProcessTexture")) {
-        UnloadRenderTexture(renderTextures["postProcessTexture"]);
-    }
-    renderTextures["postProcessTexture"] = LoadRenderTexture("postProcessTexture", w, h);
-    SetTextureWrap(renderTextures["postProcessTexture"].texture, TEXTURE_WRAP_CLAMP);
-
-    gLastW = w; gLastH = h;
+    // bloom's source size only gets set per level otherwise, fog picks it up in UpdateShaders
+    Shader& bloomShader = GetShader("bloomShader");
+    Vector2 sourceResolution = { (float)w, (float)h };
+    SetShaderValue(bloomShader, GetShaderLocation(bloomShader, "resolution"), &sourceResolution, SHADER_UNIFORM_VEC2);
 }
 
 // Fallback functions
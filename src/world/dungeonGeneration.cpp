@@ -7,7 +7,14 @@
 #include "util/sound_manager.h"
 #include "util/resourceManager.h"
 #include "util/utilities.h"
+#include "util/collisionWorld.h"
 #include "world/dungeonColors.h"
+#include "world/pvs.h"
+#include "world/rooms.h"
+#include "render/dungeonChunks.h"
+#include "render/frustum.h"
+#include "render/renderQueue.h"
+#include "util/camera_system.h"
 
 std::vector<uint8_t> lavaMask; // width*height, 1 = lava, 0 = not
 
@@ -241,8 +248,12 @@ inline bool IsLava(int gx, int gy) {
     return lavaMask[Idx(gx,gy)] != 0;
 }
 
+static const Vector3 kTileScale = {700, 700, 700};
+
 void GenerateCeilingTiles() {
     ceilingTiles.clear();
+    ClearDungeonChunkLayer(CHUNK_CEILING);
+    const Model& ceilingModel = ResourceManager::Get().GetModel("floorTileGray");
 
     //fill the whole dungeon with ceiling tiles. 
     for (int y = 0; y < dungeonHeight; y++) {
@@ -258,6 +269,7 @@ void GenerateCeilingTiles() {
             ceiling.position = pos;
             ceiling.tint = GRAY;
             ceilingTiles.push_back(ceiling);
+            AddDungeonChunkPiece(CHUNK_CEILING, x, y, ceilingModel, pos, {1, 0, 0}, 180.0f, kTileScale); // floor tile flipped upside down
 
         }
 
@@ -267,6 +279,8 @@ void GenerateCeilingTiles() {
 void GenerateFloorTiles(float baseY) {
     floorTiles.clear();
     lavaTiles.clear();
+    ClearDungeonChunkLayer(CHUNK_FLOOR);
+    const Model& floorModel = ResourceManager::Get().GetModel("floorTileGray");
 
     lavaMask.assign(dungeonWidth * dungeonHeight, 0);
     for (int y = 0; y < dungeonHeight; y++) {
@@ -296,6 +310,7 @@ void GenerateFloorTiles(float baseY) {
             tile.tint = WHITE; 
             tile.floorType = FloorType::Normal;
             floorTiles.push_back(tile);
+            AddDungeonChunkPiece(CHUNK_FLOOR, x, y, floorModel, pos, {0, 1, 0}, 0.0f, kTileScale);
         }
     }
 }
@@ -307,6 +322,8 @@ void GenerateWallTiles(float baseY) {
     //and create bounding boxes
     wallInstances.clear();
     wallRunColliders.clear();
+    ClearDungeonChunkLayer(CHUNK_WALLS);
+    const Model& wallModel = ResourceManager::Get().GetModel("wallSegment");
 
     float wallThickness = 50.0f;
     float wallHeight = 400.0f;
@@ -337,6 +354,7 @@ void GenerateWallTiles(float baseY) {
                     wall.rotationY = 90.0f;
                     wall.tint = WHITE;
                     wallInstances.push_back(wall);
+                    AddDungeonChunkPiece(CHUNK_WALLS, x, y, wallModel, mid, {0, 1, 0}, wall.rotationY, kTileScale);
 
                     // Move them down to match the wall visuals
                     a.y -= 190.0f;
@@ -366,6 +384,7 @@ void GenerateWallTiles(float baseY) {
                     wall.rotationY = 0.0f;
                     wall.tint = WHITE;
                     wallInstances.push_back(wall);
+                    AddDungeonChunkPiece(CHUNK_WALLS, x, y, wallModel, mid, {0, 1, 0}, wall.rotationY, kTileScale);
 
                     a.y -= 190.0f;
                     b.y -= 190.0f;
@@ -475,6 +494,8 @@ void GenerateDoorways(float baseY, int currentLevelIndex) {
 
             Vector3 pos = GetDungeonWorldPos(x, y, tileSize, baseY);
             DoorwayInstance archway = { pos, rotationY, false, false, false, WHITE };
+            archway.tileX = x;
+            archway.tileY = y;
 
             GenerateSideColliders(pos, rotationY, archway);
 
@@ -779,6 +800,8 @@ void AddLavaSkirtEdge(int x, int y, int dir, float baseY) {
     skirt.position  = mid;
 
     wallInstances.push_back(skirt);
+    // drawn at the regular wall scale like before, skirt.scale only shapes the collider
+    AddDungeonChunkPiece(CHUNK_WALLS, x, y, ResourceManager::Get().GetModel("wallSegment"), mid, {0, 1, 0}, rotY, kTileScale);
 
     BoundingBox bb = MakeAABBFromSkirt(skirt, dir);
 
@@ -1392,10 +1415,13 @@ void DrawFlatWeb(Texture2D texture, Vector3 position, float width, float height,
 
 
 void DrawLaunchers() {
+    Model& pillarModel = ResourceManager::Get().GetModel("stonePillar");
+    const float cullRadius = ModelCullRadius(pillarModel) * 100.0f;
     for (const LauncherTrap& launcher : launchers) {
 
         Vector3 offsetPos = {launcher.position.x, launcher.position.y + 20, launcher.position.z}; 
-        DrawModelEx(ResourceManager::Get().GetModel("stonePillar"), offsetPos, Vector3{0,1,0}, 0.0f, Vector3{100, 100, 100}, WHITE);
+        if (!SphereInView(offsetPos, cullRadius) || !RoomsInView(offsetPos, 0.0f)) continue;
+        RenderQueuePushModel(pillarModel, offsetPos, Vector3{0,1,0}, 0.0f, Vector3{100, 100, 100}, WHITE);
     }
 
 }
@@ -1406,7 +1432,8 @@ void DrawDungeonBarrels() {
     for (const BarrelInstance& barrel : barrelInstances) {
         Vector3 offsetPos = {barrel.position.x, barrel.position.y + 20, barrel.position.z}; //move the barrel up a bit
         Model modelToDraw = barrel.destroyed ? ResourceManager::Get().GetModel("brokeBarrel") : ResourceManager::Get().GetModel("barrelModel");
-        DrawModelEx(modelToDraw, offsetPos, Vector3{0, 1, 0}, 0.0f, Vector3{350.0f, 350.0f, 350.0f}, barrel.tint); //scaled half size
+        if (!SphereInView(offsetPos, ModelCullRadius(modelToDraw) * 350.0f) || !RoomsInView(offsetPos, 0.0f)) continue;
+        RenderQueuePushModel(modelToDraw, offsetPos, Vector3{0, 1, 0}, 0.0f, Vector3{350.0f, 350.0f, 350.0f}, barrel.tint); //scaled half size
         
     }
 
@@ -1424,7 +1451,8 @@ void DrawDungeonChests() {
         if (chest.animFrame > 0){
             offsetPos.z -= 45;
         }
-        DrawModelEx(chest.model, offsetPos, Vector3{0, 1, 0}, 0.0f, Vector3{60.0f, 60.0f, 60.0f}, chest.tint);
+        if (!SphereInView(offsetPos, ModelCullRadius(chest.model) * 60.0f) || !RoomsInView(offsetPos, 0.0f)) continue;
+        RenderQueuePushModel(chest.model, offsetPos, Vector3{0, 1, 0}, 0.0f, Vector3{60.0f, 60.0f, 60.0f}, chest.tint);
     }
     
 }
@@ -1437,19 +1465,11 @@ static inline void SetIsCeilingUniform(bool yes, Shader s) {
 
 
 void DrawDungeonCeiling(){
-    const float cull_radius = 5400;
-    Model& ceilingModel = ResourceManager::Get().GetModel("floorTileGray");
-
+    //own flush, the isCeiling uniform and culling only hold for these. call it after the main queue flush
     SetIsCeilingUniform(true, ResourceManager::Get().GetShader("lightingShader"));
     rlEnableBackfaceCulling();
-    for (CeilingTile& tile : ceilingTiles){
-        float dist = Vector3Distance(player.position, tile.position);
-        if (dist < cull_radius){
-            DrawModelEx(ceilingModel, tile.position, {1,0,0}, 180.0f, Vector3{700, 700, 700}, tile.tint);
-        }
-
-    }
-        
+    DrawDungeonChunks(CHUNK_CEILING, GRAY);
+    RenderQueueFlush(CameraSystem::Get().Active().position);
     rlDisableBackfaceCulling();
     SetIsCeilingUniform(false, ResourceManager::Get().GetShader("lightingShader"));
 }
@@ -1457,40 +1477,32 @@ void DrawDungeonCeiling(){
 
 void DrawDungeonFloor() {
 
-    Model& floorModel = ResourceManager::Get().GetModel("floorTileGray");
     Model& lavaModel = ResourceManager::Get().GetModel("lavaTile");
-    const float cull_radius = 10000.0f;
+    const float lavaRadius = ModelCullRadius(lavaModel) * kTileScale.x;
 
-    const Vector3 baseScale   = {700, 700, 700};
-
-    for (const FloorTile& tile : floorTiles) {
-        float dist = Vector3Distance(player.position, tile.position);
-        if (dist < cull_radius){
-            DrawModelEx(floorModel, tile.position, {0,1,0}, 0.0f, baseScale, tile.tint);    
-        }
-        
-    }
+    DrawDungeonChunks(CHUNK_FLOOR, WHITE); //frustum + PVS per chunk, replaces the per tile distance check
 
+    // lava is a handful of tiles on its own shader, not worth a chunk layer
     for (const FloorTile& lavaTile : lavaTiles){
-        DrawModelEx(lavaModel, lavaTile.position, {0, 1, 0}, 0.0f, baseScale, lavaTile.tint);
+        if (!PVSInView(lavaTile.position, 0.0f) || !SphereInView(lavaTile.position, lavaRadius) || !RoomsInView(lavaTile.position, 0.0f)) continue;
+        RenderQueuePushModel(lavaModel, lavaTile.position, {0, 1, 0}, 0.0f, kTileScale, lavaTile.tint);
     }
 
 }
 
 void DrawDungeonWalls() {
 
-    for (const WallInstance& _wall : wallInstances) {
-        // "wall"
-        DrawModelEx(ResourceManager::Get().GetModel("wallSegment"), _wall.position, Vector3{0, 1, 0}, _wall.rotationY, Vector3{700, 700, 700}, _wall.tint);
-
-    }
+    DrawDungeonChunks(CHUNK_WALLS, WHITE);
 }
 
 void DrawDungeonDoorways(){
 
+    Model& doorwayModel = ResourceManager::Get().GetModel("doorWayGray");
+    const float cullRadius = ModelCullRadius(doorwayModel) * 595.0f; //largest axis of the scale below
     for (const DoorwayInstance& d : doorways) {
         Vector3 dPos = {d.position.x, d.position.y + 100, d.position.z};
-        DrawModelEx(ResourceManager::Get().GetModel("doorWayGray"), dPos, {0, 1, 0}, d.rotationY * RAD2DEG, {490, 595, 476}, d.tint);
+        if (!SphereInView(dPos, cullRadius) || !RoomsInView(dPos, 0.0f)) continue;
+        RenderQueuePushModel(doorwayModel, dPos, {0, 1, 0}, d.rotationY * RAD2DEG, {490, 595, 476}, d.tint);
     }
 
 }
@@ -1513,6 +1525,7 @@ void DrawFlatDoor(Texture2D tex, Vector3 pos, float width, float height, float r
     Vector3 topRight    = Vector3Add(bottomRight, {0, h, 0});
     BeginBlendMode(BLEND_ALPHA);
     if (!isDungeon) BeginShaderMode(ResourceManager::Get().GetShader("treeShader")); //fog on flat door at distance in jungle
+    rlDrawRenderBatchActive(); // depth state isn't part of the rlgl batch, draw what's queued before changing it
     rlEnableDepthTest();   // make sure testing is on
     rlDisableDepthMask();  // <-- NO depth writes from the portal..still occludes bullets for some reason. 
     rlSetTexture(tex.id);
@@ -1526,6 +1539,7 @@ void DrawFlatDoor(Texture2D tex, Vector3 pos, float width, float height, float r
     rlEnd();
     rlSetTexture(0);
     rlColor4ub(255, 255, 255, 255);
+    rlDrawRenderBatchActive(); // the door itself still without depth writes
     rlEnableDepthMask();
     EndBlendMode();
     EndShaderMode();
@@ -1536,12 +1550,15 @@ void DrawFlatDoor(Texture2D tex, Vector3 pos, float width, float height, float r
 
 void DrawDungeonPillars() {
     //Pillars means Pedestal fire light sources. Light sources are generated separatly and spawn at pillar positions. 
+    Model& lampModel = ResourceManager::Get().GetModel("lampModel");
+    const float cullRadius = ModelCullRadius(lampModel) * 350.0f;
     for (size_t i = 0; i < pillars.size(); ++i) {
         const PillarInstance& pillar = pillars[i];
         //Fire& fire = fires[i];
+        if (!SphereInView(pillar.position, cullRadius) || !RoomsInView(pillar.position, 0.0f)) continue;
 
         // Draw the pedestal model
-        DrawModelEx(ResourceManager::Get().GetModel("lampModel"), pillar.position, Vector3{0, 1, 0}, pillar.rotation, Vector3{350, 350, 350}, WHITE);
+        RenderQueuePushModel(lampModel, pillar.position, Vector3{0, 1, 0}, pillar.rotation, Vector3{350, 350, 350}, WHITE);
 
     }
 }
@@ -1662,9 +1679,13 @@ void GatherFrameLights() {
 
 void ClearDungeon() {
     wallRunColliders.clear();
+    ClearStaticColliders();
+    ClearDungeonPVS();
+    ClearDungeonRooms();
     floorTiles.clear();
     wallInstances.clear();
     ceilingTiles.clear();
+    UnloadDungeonChunks();
     pillars.clear();
     barrelInstances.clear();
     dungeonLights.clear();
@@ -0,0 +1,433 @@
+#include "world/pvs.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "util/job_pool.h"
+#include "world/dungeonColors.h"
+#include "world/dungeonGeneration.h"
+#include "world/world.h"
+
+// Blockers are rasterized onto a fine grid, kSub x kSub cells per tile. A cell only blocks
+// if a wall collider covers it completely, so the grid never blocks more than the real walls.
+//
+// The bake casts rays between kSamples x kSamples points per tile. Any point of a tile is within
+// kSampleReach of a sample on both axes, so any real sight line has a sampled ray that stays within that
+// distance of it the whole way. The rays test an eroded copy of the grid (a cell blocks only if every
+// cell within kErodeCells of it does), so a ray that hits something means every line near it does too,
+// and a line of sight the samples miss still sets its bit. Thin blockers erode away, which only costs culling.
+static constexpr int   kSub = 8;
+static constexpr int   kMaxRange = 24; // tiles. pairs further apart than this are never baked (always "visible")
+static constexpr int   kSamples = 2;   // per tile axis, at cell centers of a kSamples x kSamples split
+static constexpr float kSampleReach = 0.5f / kSamples * 1.41421356f; // tiles, farthest any point is from a sample
+static constexpr int   kErodeCells = (int)(kSampleReach * kSub) + 1; // ceil, in fine cells
+
+struct PVSDoorDep {
+    int target;   // image tile index
+    int door;     // index into doors, -1 = needs more than one door, visible when any door is open
+};
+
+static int gPvsW = 0, gPvsH = 0;
+static bool gPvsBuilt = false;
+static std::vector<uint8_t> gPvsSource;                   // 1 = tile has a baked row
+static std::vector<std::vector<uint8_t>> gPvsRows;        // zero-run compressed bitset per source tile
+static std::vector<std::vector<PVSDoorDep>> gPvsDoorDeps; // pairs only blocked by closed doors, sorted by target
+
+static int gFineW = 0, gFineH = 0;
+static std::vector<uint8_t> gFineWall;         // as rasterized, shared with the light bake
+static std::vector<uint8_t> gRayWall;          // eroded walls, bake only
+static std::vector<int16_t> gRayDoor;          // eroded walls + closed doorways: door index, -1 several, -2 none
+
+static bool gViewValid = false;
+static int gViewTile = -1;
+static std::vector<uint8_t> gViewBits;
+
+// --- compression -----------------------------------------------------------------------
+// Zero bytes are stored as a 0 followed by the run length (1..255), everything else is literal.
+// Most of a row is zeros (walls, far side of the map), so rows shrink to a few dozen bytes.
+
+static std::vector<uint8_t> CompressRow(const std::vector<uint8_t>& bits) {
+    std::vector<uint8_t> out;
+    for (size_t i = 0; i < bits.size();) {
+        if (bits[i] != 0) {
+            out.push_back(bits[i++]);
+            continue;
+        }
+        int run = 0;
+        while (i < bits.size() && bits[i] == 0 && run < 255) { run++; i++; }
+        out.push_back(0);
+        out.push_back((uint8_t)run);
+    }
+    return out;
+}
+
+static void DecompressRow(const std::vector<uint8_t>& row, std::vector<uint8_t>& bits) {
+    std::fill(bits.begin(), bits.end(), 0);
+    size_t pos = 0;
+    for (size_t i = 0; i < row.size() && pos < bits.size();) {
+        if (row[i] == 0) {
+            pos += row[i + 1];
+            i += 2;
+        } else {
+            bits[pos++] = row[i++];
+        }
+    }
+}
+
+static bool TestCompressedBit(const std::vector<uint8_t>& row, int bit) {
+    size_t target = (size_t)bit >> 3;
+    size_t pos = 0;
+    for (size_t i = 0; i < row.size();) {
+        if (row[i] == 0) {
+            pos += row[i + 1];
+            if (target < pos) return false;
+            i += 2;
+        } else {
+            if (pos == target) return (row[i] >> (bit & 7)) & 1;
+            pos++;
+            i++;
+        }
+    }
+    return false;
+}
+
+// --- bake ------------------------------------------------------------------------------
+
+static void RasterizeBlocker(const BoundingBox& b) {
+    const float cell = tileSize / kSub;
+    const float eps = 0.01f;
+    int fx0 = (int)std::ceil((b.min.x - eps) / cell);
+    int fx1 = (int)std::floor((b.max.x + eps) / cell) - 1;
+    int fz0 = (int)std::ceil((b.min.z - eps) / cell);
+    int fz1 = (int)std::floor((b.max.z + eps) / cell) - 1;
+    fx0 = std::max(fx0, 0); fz0 = std::max(fz0, 0);
+    fx1 = std::min(fx1, gFineW - 1); fz1 = std::min(fz1, gFineH - 1);
+    for (int fz = fz0; fz <= fz1; fz++) {
+        for (int fx = fx0; fx <= fx1; fx++) {
+            gFineWall[fz * gFineW + fx] = 1;
+        }
+    }
+}
+
+// Minimum of the neighbourhood, separable: rows, then columns. Cells off the grid count as solid,
+// the map edge is wall anyway.
+template <typename T, typename Combine>
+static void ErodeGrid(std::vector<T>& grid, T outside, Combine combine) {
+    const int r = kErodeCells;
+    std::vector<T> tmp(grid.size());
+    for (int z = 0; z < gFineH; z++) {
+        for (int x = 0; x < gFineW; x++) {
+            T v = grid[z * gFineW + x];
+            for (int o = -r; o <= r; o++) {
+                const int nx = x + o;
+                v = combine(v, (nx < 0 || nx >= gFineW) ? outside : grid[z * gFineW + nx]);
+            }
+            tmp[z * gFineW + x] = v;
+        }
+    }
+    for (int z = 0; z < gFineH; z++) {
+        for (int x = 0; x < gFineW; x++) {
+            T v = tmp[z * gFineW + x];
+            for (int o = -r; o <= r; o++) {
+                const int nz = z + o;
+                v = combine(v, (nz < 0 || nz >= gFineH) ? outside : tmp[nz * gFineW + x]);
+            }
+            grid[z * gFineW + x] = v;
+        }
+    }
+}
+
+// A closed door fills its whole doorway tile here. The doorway sits in a wall line, so a straight line that
+// goes into the tile and out again without ending in it has to cross the door.
+static void BuildRayGrids() {
+    const int16_t kNone = -2, kSolid = -3, kSeveral = -1;
+
+    gRayWall = gFineWall;
+    ErodeGrid<uint8_t>(gRayWall, 1, [](uint8_t a, uint8_t b) { return (uint8_t)std::min(a, b); });
+
+    gRayDoor.assign(gFineWall.size(), kNone);
+    for (size_t i = 0; i < gFineWall.size(); i++) if (gFineWall[i]) gRayDoor[i] = kSolid;
+    for (int d = 0; d < (int)doors.size(); d++) {
+        const int kx = gPvsW - 1 - doors[d].tileX, kz = gPvsH - 1 - doors[d].tileY;
+        if (kx < 0 || kz < 0 || kx >= gPvsW || kz >= gPvsH) continue;
+        for (int fz = kz * kSub; fz < (kz + 1) * kSub; fz++) {
+            for (int fx = kx * kSub; fx < (kx + 1) * kSub; fx++) {
+                int16_t& c = gRayDoor[fz * gFineW + fx];
+                if (c == kNone) c = (int16_t)d;
+            }
+        }
+    }
+    // none wins, then solid gives way to any door, two different doors make "several"
+    ErodeGrid<int16_t>(gRayDoor, kSolid, [=](int16_t a, int16_t b) -> int16_t {
+        if (a == kNone || b == kNone) return kNone;
+        if (a == kSolid) return b;
+        if (b == kSolid || a == b) return a;
+        return kSeveral;
+    });
+    for (int16_t& c : gRayDoor) if (c == kSolid) c = kNone; // pure wall, gRayWall has it
+}
+
+static inline bool NearTile(int cx, int cz, int kx, int kz) {
+    return cx >= kx * kSub - kErodeCells && cx < (kx + 1) * kSub + kErodeCells
+        && cz >= kz * kSub - kErodeCells && cz < (kz + 1) * kSub + kErodeCells;
+}
+
+enum class RayResult { Blocked, Clear, DoorOnly };
+
+// Walks the fine grid from p to q (world XZ). Blockers in the source tile don't count and the ray has
+// arrived once it enters the target tile, so seeing any part of a tile is enough. Eroded cells close to
+// either end tile stand for blockers partly inside it, those don't count either.
+static RayResult CastPVSRay(float px, float pz, float qx, float qz,
+                            int srcKx, int srcKz, int dstKx, int dstKz, int& outDoor) {
+    const float cell = tileSize / kSub;
+    float x0 = px / cell, z0 = pz / cell;
+    float dx = (qx - px) / cell, dz = (qz - pz) / cell;
+
+    int cx = (int)std::floor(x0), cz = (int)std::floor(z0);
+    int stepX = dx > 0 ? 1 : -1, stepZ = dz > 0 ? 1 : -1;
+    float tDeltaX = dx != 0 ? std::fabs(1.0f / dx) : 1e30f;
+    float tDeltaZ = dz != 0 ? std::fabs(1.0f / dz) : 1e30f;
+    float tMaxX = dx != 0 ? ((stepX > 0 ? (cx + 1 - x0) : (x0 - cx)) * tDeltaX) : 1e30f;
+    float tMaxZ = dz != 0 ? ((stepZ > 0 ? (cz + 1 - z0) : (z0 - cz)) * tDeltaZ) : 1e30f;
+
+    float t = 0.0f;
+    int hitDoor = -2;
+    for (int guard = 0; guard < (kMaxRange + 2) * kSub * 4; guard++) {
+        if (cx < 0 || cz < 0 || cx >= gFineW || cz >= gFineH) return RayResult::Blocked;
+
+        int kx = cx / kSub, kz = cz / kSub;
+        if (kx == dstKx && kz == dstKz) break;
+
+        if (!NearTile(cx, cz, srcKx, srcKz) && !NearTile(cx, cz, dstKx, dstKz)) {
+            const int c = cz * gFineW + cx;
+            if (gRayWall[c]) return RayResult::Blocked;
+            const int door = gRayDoor[c];
+            if (door != -2) hitDoor = (hitDoor == -2 || hitDoor == door) ? door : -1;
+        }
+
+        if (tMaxX < tMaxZ) { t = tMaxX; tMaxX += tDeltaX; cx += stepX; }
+        else               { t = tMaxZ; tMaxZ += tDeltaZ; cz += stepZ; }
+        if (t > 1.0f) break;
+    }
+
+    if (hitDoor == -2) return RayResult::Clear;
+    outDoor = hitDoor;
+    return RayResult::DoorOnly;
+}
+
+static void TileSamples(int kx, int kz, float* xs, float* zs) {
+    for (int i = 0; i < kSamples * kSamples; i++) {
+        xs[i] = (kx + (i % kSamples + 0.5f) / kSamples) * tileSize;
+        zs[i] = (kz + (i / kSamples + 0.5f) / kSamples) * tileSize;
+    }
+}
+
+// world tile (kx, kz) is image tile (W-1-kx, H-1-kz), the dungeon image is flipped on both axes
+static void BakeSourceRow(int srcIndex) {
+    const int sx = srcIndex % gPvsW, sy = srcIndex / gPvsW;
+    const int srcKx = gPvsW - 1 - sx, srcKz = gPvsH - 1 - sy;
+
+    std::vector<uint8_t> bits((gPvsW * gPvsH + 7) / 8, 0);
+    std::vector<PVSDoorDep>& deps = gPvsDoorDeps[srcIndex];
+    deps.clear();
+
+    constexpr int kCount = kSamples * kSamples;
+    float sxs[kCount], szs[kCount], txs[kCount], tzs[kCount];
+    TileSamples(srcKx, srcKz, sxs, szs);
+
+    const int y0 = std::max(0, sy - kMaxRange), y1 = std::min(gPvsH - 1, sy + kMaxRange);
+    const int x0 = std::max(0, sx - kMaxRange), x1 = std::min(gPvsW - 1, sx + kMaxRange);
+
+    for (int ty = y0; ty <= y1; ty++) {
+        for (int tx = x0; tx <= x1; tx++) {
+            int dst = ty * gPvsW + tx;
+            if (!gPvsSource[dst]) continue;
+            if (dst == srcIndex) { bits[dst >> 3] |= (uint8_t)(1u << (dst & 7)); continue; }
+
+            const int dstKx = gPvsW - 1 - tx, dstKz = gPvsH - 1 - ty;
+            TileSamples(dstKx, dstKz, txs, tzs);
+
+            bool visible = false;
+            int depDoor = -2;
+            for (int a = 0; a < kCount && !visible; a++) {
+                for (int b = 0; b < kCount && !visible; b++) {
+                    int door = -1;
+                    RayResult r = CastPVSRay(sxs[a], szs[a], txs[b], tzs[b], srcKx, srcKz, dstKx, dstKz, door);
+                    if (r == RayResult::Clear) visible = true;
+                    else if (r == RayResult::DoorOnly) depDoor = (depDoor == -2 || depDoor == door) ? door : -1;
+                }
+            }
+
+            if (visible) bits[dst >> 3] |= (uint8_t)(1u << (dst & 7));
+            else if (depDoor != -2) deps.push_back({ dst, depDoor });
+        }
+    }
+
+    gPvsRows[srcIndex] = CompressRow(bits);
+}
+
+void BuildDungeonPVS() {
+    ClearDungeonPVS();
+    if (dungeonWidth <= 0 || dungeonHeight <= 0 || !dungeonPixels) return;
+
+    gPvsW = dungeonWidth;
+    gPvsH = dungeonHeight;
+    const int count = gPvsW * gPvsH;
+
+    //sources are open tiles plus the walls that touch one. deep wall interiors can't see or be seen.
+    auto isOpen = [](int x, int y) {
+        Color c = dungeonPixels[y * dungeonWidth + x];
+        return c.a != 0 && !dungeon::IsWallColor(c);
+    };
+    gPvsSource.assign(count, 0);
+    for (int y = 0; y < gPvsH; y++) {
+        for (int x = 0; x < gPvsW; x++) {
+            if (dungeonPixels[y * gPvsW + x].a == 0) continue;
+            bool src = isOpen(x, y);
+            for (int oy = -1; oy <= 1 && !src; oy++) {
+                for (int ox = -1; ox <= 1 && !src; ox++) {
+                    int nx = x + ox, ny = y + oy;
+                    if (nx >= 0 && ny >= 0 && nx < gPvsW && ny < gPvsH && isOpen(nx, ny)) src = true;
+                }
+            }
+            gPvsSource[y * gPvsW + x] = src ? 1 : 0;
+        }
+    }
+
+    //eye-level blockers only. lava skirts stop below the floor line, rays pass over them
+    gFineW = gPvsW * kSub;
+    gFineH = gPvsH * kSub;
+    gFineWall.assign(gFineW * gFineH, 0);
+    for (const WallRun& run : wallRunColliders) {
+        if (run.bounds.max.y < floorHeight + 50.0f) continue;
+        RasterizeBlocker(run.bounds);
+    }
+    for (const DoorwayInstance& dw : doorways) {
+        for (const BoundingBox& side : dw.sideColliders) RasterizeBlocker(side);
+    }
+
+    BuildRayGrids();
+
+    gPvsRows.assign(count, {});
+    gPvsDoorDeps.assign(count, {});
+
+    std::vector<int> sources;
+    for (int i = 0; i < count; i++) if (gPvsSource[i]) sources.push_back(i);
+
+    JobPool::Get().ParallelFor(sources.size(), 8, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) BakeSourceRow(sources[i]);
+    });
+    gRayWall = {};
+    gRayDoor = {};
+
+    size_t bytes = 0;
+    for (const std::vector<uint8_t>& row : gPvsRows) bytes += row.size();
+    TraceLog(LOG_INFO, "PVS: %d source tiles, %zu compressed bytes (%zu raw)",
+             (int)sources.size(), bytes, sources.size() * ((count + 7) / 8));
+
+    gViewBits.assign((count + 7) / 8, 0);
+    gPvsBuilt = true;
+}
+
+void ClearDungeonPVS() {
+    gPvsBuilt = false;
+    gPvsW = gPvsH = 0;
+    gPvsSource.clear();
+    gPvsRows.clear();
+    gPvsDoorDeps.clear();
+    gFineWall.clear();
+    gRayWall.clear();
+    gRayDoor.clear();
+    gViewValid = false;
+    gViewTile = -1;
+}
+
+// --- queries ---------------------------------------------------------------------------
+
+PVSOccluderGrid GetPVSOccluderGrid() {
+    PVSOccluderGrid g;
+    if (gFineWall.empty()) return g;
+    g.cells = gFineWall.data();
+    g.w = gFineW;
+    g.h = gFineH;
+    g.cellsPerTile = kSub;
+    return g;
+}
+
+static bool AnyDoorOpen() {
+    for (const Door& door : doors) if (door.isOpen) return true;
+    return false;
+}
+
+static bool DoorDepVisible(const PVSDoorDep& dep) {
+    if (dep.door < 0) return AnyDoorOpen();
+    return dep.door < (int)doors.size() && doors[dep.door].isOpen;
+}
+
+static bool WorldToImageTile(Vector3 p, int& x, int& y) {
+    if (p.x < 0.0f || p.z < 0.0f) return false;
+    x = GetDungeonImageX(p.x, tileSize, gPvsW);
+    y = GetDungeonImageY(p.z, tileSize, gPvsH);
+    return x >= 0 && y >= 0 && x < gPvsW && y < gPvsH;
+}
+
+bool PVSTileVisible(int ax, int ay, int bx, int by) {
+    if (!gPvsBuilt) return true;
+    if (ax < 0 || ay < 0 || ax >= gPvsW || ay >= gPvsH) return true;
+    if (bx < 0 || by < 0 || bx >= gPvsW || by >= gPvsH) return true;
+    if (std::abs(ax - bx) > kMaxRange || std::abs(ay - by) > kMaxRange) return true;
+
+    const int a = ay * gPvsW + ax, b = by * gPvsW + bx;
+    if (!gPvsSource[a] || !gPvsSource[b]) return true;
+    if (TestCompressedBit(gPvsRows[a], b)) return true;
+
+    const std::vector<PVSDoorDep>& deps = gPvsDoorDeps[a];
+    auto it = std::lower_bound(deps.begin(), deps.end(), b, [](const PVSDoorDep& d, int t) { return d.target < t; });
+    return it != deps.end() && it->target == b && DoorDepVisible(*it);
+}
+
+bool PVSWorldVisible(Vector3 from, Vector3 to) {
+    if (!gPvsBuilt) return true;
+    int ax, ay, bx, by;
+    if (!WorldToImageTile(from, ax, ay) || !WorldToImageTile(to, bx, by)) return true;
+    return PVSTileVisible(ax, ay, bx, by);
+}
+
+void PVSBeginView(Vector3 cameraPos) {
+    gViewValid = false;
+    if (!gPvsBuilt || !isDungeon) return;
+
+    int x, y;
+    if (!WorldToImageTile(cameraPos, x, y)) return;
+    const int tile = y * gPvsW + x;
+    if (!gPvsSource[tile]) return;
+
+    //door state can change any frame, so the dependent bits are re-applied every time
+    DecompressRow(gPvsRows[tile], gViewBits);
+    for (const PVSDoorDep& dep : gPvsDoorDeps[tile]) {
+        if (DoorDepVisible(dep)) gViewBits[dep.target >> 3] |= (uint8_t)(1u << (dep.target & 7));
+    }
+    gViewTile = tile;
+    gViewValid = true;
+}
+
+bool PVSInView(Vector3 worldPos, float radius) {
+    if (!gViewValid) return true;
+
+    const int vx = gViewTile % gPvsW, vy = gViewTile / gPvsW;
+    int x0, y0, x1, y1;
+    Vector3 lo = { worldPos.x - radius, worldPos.y, worldPos.z - radius };
+    Vector3 hi = { worldPos.x + radius, worldPos.y, worldPos.z + radius };
+    if (!WorldToImageTile(lo, x1, y1) || !WorldToImageTile(hi, x0, y0)) return true; // image axes are flipped
+
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            if (std::abs(x - vx) > kMaxRange || std::abs(y - vy) > kMaxRange) return true;
+            const int t = y * gPvsW + x;
+            if (!gPvsSource[t]) return true;
+            if (gViewBits[t >> 3] & (1u << (t & 7))) return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,265 @@
+#include "world/rooms.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "raymath.h"
+#include "render/frustum.h"
+#include "world/dungeonColors.h"
+#include "world/dungeonGeneration.h"
+#include "world/world.h"
+
+static constexpr int kTileRoomSlots = 4;   // rooms a wall or doorway tile can border
+static constexpr int kMaxPortalDepth = 12; // doorways deep, the rest of the chain counts as visible
+static constexpr int kMaxRoomVisits = 512;  // per frame, past that the traversal gives up and shows everything
+static constexpr int16_t kNoRoom = -1;
+static constexpr int16_t kAnyRoom = -2;    // tile borders too many rooms to list, always visible
+
+struct RoomPortal {
+    int rooms[2];
+    int doorway;       // index into doorways
+    int door;          // index into doors, -1 for an archway without one
+    BoundingBox bounds;
+    Vector3 corners[4]; // bottom left, bottom right, top right, top left, as seen along the opening
+    Vector3 center;
+};
+
+static int gRoomsW = 0, gRoomsH = 0;
+static bool gRoomsBuilt = false;
+static std::vector<int16_t> gTileRoom;           // room per tile, kNoRoom for walls, void and doorways
+static std::vector<int16_t> gTileRoomSlots;      // kTileRoomSlots per tile, rooms the tile is seen from
+static std::vector<std::vector<int>> gRoomPortals; // portal indices per room
+static std::vector<RoomPortal> gPortals;
+
+static bool gRoomViewValid = false;
+static std::vector<uint8_t> gRoomVisible;
+static std::vector<int> gPortalPath; // portals on the current traversal path
+static int gVisitsLeft = 0;
+
+void ClearDungeonRooms() {
+    gRoomsBuilt = false;
+    gRoomViewValid = false;
+    gRoomsW = gRoomsH = 0;
+    gTileRoom.clear();
+    gTileRoomSlots.clear();
+    gRoomPortals.clear();
+    gPortals.clear();
+    gRoomVisible.clear();
+}
+
+static bool InRoomGrid(int x, int y) {
+    return x >= 0 && y >= 0 && x < gRoomsW && y < gRoomsH;
+}
+
+static void AddTileRoomSlot(int tile, int16_t room) {
+    int16_t* slots = &gTileRoomSlots[(size_t)tile * kTileRoomSlots];
+    if (room < 0 || slots[0] == kAnyRoom) return;
+    for (int i = 0; i < kTileRoomSlots; i++) {
+        if (slots[i] == room) return;
+        if (slots[i] == kNoRoom) { slots[i] = room; return; }
+    }
+    slots[0] = kAnyRoom;
+}
+
+void BuildDungeonRooms() {
+    ClearDungeonRooms();
+    if (!dungeonPixels || dungeonWidth <= 0 || dungeonHeight <= 0) return;
+
+    gRoomsW = dungeonWidth;
+    gRoomsH = dungeonHeight;
+    const int count = gRoomsW * gRoomsH;
+
+    std::vector<uint8_t> isDoorway(count, 0);
+    for (const DoorwayInstance& dw : doorways) {
+        if (InRoomGrid(dw.tileX, dw.tileY)) isDoorway[dw.tileY * gRoomsW + dw.tileX] = 1;
+    }
+
+    // flood fill everything you can walk (or fall) into, doorways split it up
+    gTileRoom.assign(count, kNoRoom);
+    std::vector<int> stack;
+    int16_t roomCount = 0;
+    for (int start = 0; start < count; start++) {
+        const Color c = dungeonPixels[start];
+        if (gTileRoom[start] != kNoRoom || c.a == 0 || dungeon::IsWallColor(c) || isDoorway[start]) continue;
+        if (roomCount == INT16_MAX) break;
+
+        const int16_t room = roomCount++;
+        gTileRoom[start] = room;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            const int t = stack.back();
+            stack.pop_back();
+            const int tx = t % gRoomsW, ty = t / gRoomsW;
+            const int nx[4] = { tx + 1, tx - 1, tx, tx };
+            const int ny[4] = { ty, ty, ty + 1, ty - 1 };
+            for (int i = 0; i < 4; i++) {
+                if (!InRoomGrid(nx[i], ny[i])) continue;
+                const int n = ny[i] * gRoomsW + nx[i];
+                const Color nc = dungeonPixels[n];
+                if (gTileRoom[n] != kNoRoom || nc.a == 0 || dungeon::IsWallColor(nc) || isDoorway[n]) continue;
+                gTileRoom[n] = room;
+                stack.push_back(n);
+            }
+        }
+    }
+
+    // room tiles list themselves, walls and doorways list every room around them (8-neighbourhood, so corners count)
+    gTileRoomSlots.assign((size_t)count * kTileRoomSlots, kNoRoom);
+    for (int y = 0; y < gRoomsH; y++) {
+        for (int x = 0; x < gRoomsW; x++) {
+            const int t = y * gRoomsW + x;
+            if (gTileRoom[t] != kNoRoom) {
+                AddTileRoomSlot(t, gTileRoom[t]);
+                continue;
+            }
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    if (InRoomGrid(x + dx, y + dy)) AddTileRoomSlot(t, gTileRoom[(y + dy) * gRoomsW + x + dx]);
+                }
+            }
+        }
+    }
+
+    // one portal per doorway, between the rooms on its open sides
+    gRoomPortals.assign(roomCount, {});
+    const float halfWidth = tileSize;             // the opening runs from wall tile centre to wall tile centre
+    const float bottom = floorHeight - tileSize;  // generous, lava pits and thresholds sit below the floor
+    const float top = ceilingHeight + tileSize * 0.5f;
+    for (int d = 0; d < (int)doorways.size(); d++) {
+        const DoorwayInstance& dw = doorways[d];
+        const int x = dw.tileX, y = dw.tileY;
+        if (!InRoomGrid(x - 1, y - 1) || !InRoomGrid(x + 1, y + 1)) continue;
+
+        // same orientation rule as GenerateDoorways: walls left and right means you walk through up/down
+        const bool acrossX = fabsf(dw.rotationY - 90.0f * DEG2RAD) < 1e-3f;
+        const int a = acrossX ? gTileRoom[(y - 1) * gRoomsW + x] : gTileRoom[y * gRoomsW + x - 1];
+        const int b = acrossX ? gTileRoom[(y + 1) * gRoomsW + x] : gTileRoom[y * gRoomsW + x + 1];
+        if (a == kNoRoom || b == kNoRoom || a == b) continue;
+
+        const Vector3 side0 = acrossX ? GetDungeonWorldPos(x - 1, y, tileSize, 0.0f) : GetDungeonWorldPos(x, y - 1, tileSize, 0.0f);
+        const Vector3 side1 = acrossX ? GetDungeonWorldPos(x + 1, y, tileSize, 0.0f) : GetDungeonWorldPos(x, y + 1, tileSize, 0.0f);
+        const Vector3 along = Vector3Scale(Vector3Normalize(Vector3Subtract(side1, side0)), halfWidth);
+        const Vector3 mid = GetDungeonWorldPos(x, y, tileSize, 0.0f);
+
+        RoomPortal portal;
+        portal.rooms[0] = a;
+        portal.rooms[1] = b;
+        portal.doorway = d;
+        portal.door = -1;
+        for (int i = 0; i < (int)doors.size(); i++) {
+            if (doors[i].tileX == x && doors[i].tileY == y) portal.door = i;
+        }
+        portal.corners[0] = { mid.x - along.x, bottom, mid.z - along.z };
+        portal.corners[1] = { mid.x + along.x, bottom, mid.z + along.z };
+        portal.corners[2] = { mid.x + along.x, top,    mid.z + along.z };
+        portal.corners[3] = { mid.x - along.x, top,    mid.z - along.z };
+        portal.center = { mid.x, 0.5f * (bottom + top), mid.z };
+        portal.bounds.min = Vector3Min(portal.corners[0], portal.corners[2]);
+        portal.bounds.max = Vector3Max(portal.corners[0], portal.corners[2]);
+
+        gRoomPortals[a].push_back((int)gPortals.size());
+        gRoomPortals[b].push_back((int)gPortals.size());
+        gPortals.push_back(portal);
+    }
+
+    gRoomVisible.assign(roomCount, 0);
+    gRoomsBuilt = true;
+}
+
+static bool PortalOpen(const RoomPortal& portal) {
+    if (portal.door < 0 || portal.door >= (int)doors.size()) return true; // archway without a door
+    return doors[portal.door].isOpen;
+}
+
+// Plane through the camera and one portal edge, turned so the portal centre is inside.
+static Vector4 EdgePlane(Vector3 eye, Vector3 a, Vector3 b, Vector3 inside) {
+    Vector3 n = Vector3Normalize(Vector3CrossProduct(Vector3Subtract(a, eye), Vector3Subtract(b, eye)));
+    float d = -Vector3DotProduct(n, eye);
+    if (Vector3DotProduct(n, inside) + d < 0.0f) { n = Vector3Negate(n); d = -d; }
+    return { n.x, n.y, n.z, d };
+}
+
+// Frustum looking through the portal. Only the edge planes and the view's near/far, so it can be a bit
+// wider than the true intersection with the parent, never narrower.
+static Frustum PortalFrustum(const Frustum& parent, Vector3 eye, const RoomPortal& portal) {
+    Frustum f = parent;
+    for (int i = 0; i < 4; i++) {
+        f.planes[i] = EdgePlane(eye, portal.corners[i], portal.corners[(i + 1) % 4], portal.center);
+    }
+    return f;
+}
+
+static void VisitRoom(int room, const Frustum& frustum, Vector3 eye, int depth) {
+    gRoomVisible[room] = 1;
+    if (gVisitsLeft <= 0) return;
+    gVisitsLeft--;
+
+    for (int p : gRoomPortals[room]) {
+        if (std::find(gPortalPath.begin(), gPortalPath.end(), p) != gPortalPath.end()) continue;
+
+        const RoomPortal& portal = gPortals[p];
+        const int other = (portal.rooms[0] == room) ? portal.rooms[1] : portal.rooms[0];
+        if (!PortalOpen(portal)) continue; // closed doors are the occluders
+        if (!FrustumHasBox(frustum, portal.bounds)) continue;
+
+        if (depth >= kMaxPortalDepth) {
+            gRoomVisible[other] = 1;
+            continue;
+        }
+
+        // standing in or right next to the doorway the edge planes fold up, look through with the parent
+        const float dx = eye.x - portal.center.x, dz = eye.z - portal.center.z;
+        const bool close = dx*dx + dz*dz < tileSize * tileSize;
+
+        gPortalPath.push_back(p);
+        VisitRoom(other, close ? frustum : PortalFrustum(frustum, eye, portal), eye, depth + 1);
+        gPortalPath.pop_back();
+    }
+}
+
+void RoomsBeginView(Vector3 cameraPos) {
+    gRoomViewValid = false;
+    if (!gRoomsBuilt || !isDungeon || gRoomVisible.empty()) return;
+
+    const int x = GetDungeonImageX(cameraPos.x, tileSize, gRoomsW);
+    const int y = GetDungeonImageY(cameraPos.z, tileSize, gRoomsH);
+    if (!InRoomGrid(x, y)) return;
+
+    // camera in a doorway or clipping a wall: start from every room the tile borders
+    const int16_t* slots = &gTileRoomSlots[(size_t)(y * gRoomsW + x) * kTileRoomSlots];
+    if (slots[0] == kNoRoom || slots[0] == kAnyRoom) return;
+
+    std::fill(gRoomVisible.begin(), gRoomVisible.end(), 0);
+    gPortalPath.clear();
+    gVisitsLeft = kMaxRoomVisits;
+    for (int i = 0; i < kTileRoomSlots && slots[i] >= 0; i++) {
+        VisitRoom(slots[i], GetViewFrustum(), cameraPos, 0);
+    }
+    gRoomViewValid = gVisitsLeft > 0; // ran out half way, the visible set is incomplete
+}
+
+bool RoomsInView(Vector3 worldPos, float radius) {
+    if (!gRoomViewValid) return true;
+
+    int x0 = GetDungeonImageX(worldPos.x - radius, tileSize, gRoomsW);
+    int x1 = GetDungeonImageX(worldPos.x + radius, tileSize, gRoomsW);
+    int y0 = GetDungeonImageY(worldPos.z - radius, tileSize, gRoomsH);
+    int y1 = GetDungeonImageY(worldPos.z + radius, tileSize, gRoomsH);
+    if (x0 > x1) std::swap(x0, x1); // image axes are flipped
+    if (y0 > y1) std::swap(y0, y1);
+    if (x1 < 0 || y1 < 0 || x0 >= gRoomsW || y0 >= gRoomsH) return true;
+    x0 = std::max(x0, 0); y0 = std::max(y0, 0);
+    x1 = std::min(x1, gRoomsW - 1); y1 = std::min(y1, gRoomsH - 1);
+
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) {
+            const int16_t* slots = &gTileRoomSlots[(size_t)(y * gRoomsW + x) * kTileRoomSlots];
+            if (slots[0] == kAnyRoom) return true;
+            for (int i = 0; i < kTileRoomSlots && slots[i] >= 0; i++) {
+                if (gRoomVisible[slots[i]]) return true;
+            }
+        }
+    }
+    return false;
+}
@@ -1,6 +1,8 @@
 #include "world/vegetation.h"
 
 #include <algorithm>
+#include "render/vegetationBatch.h"
+#include "util/camera_system.h"
 #include "util/resourceManager.h"
 #include "world/world.h"
 
@@ -60,6 +62,8 @@ void generateVegetation(){
 
     BuildTreeShadowMask_Tex(gTreeShadowMask, trees, ResourceManager::Get().GetTexture("treeShadow"));
 
+    if (!isDungeon) BuildVegetationLods(); //simplified meshes and impostors for the instanced draw
+
     // Bake
     // BuildTreeShadowMask(gTreeShadowMask, trees,
     //     /*baseRadiusMeters*/ 4.5f,  /*darknessCenter*/ 0.55f, /*rings*/ 10);
@@ -214,36 +218,35 @@ void RemoveAllVegetation() {
     trees.clear();
     bushes.clear();
     sortedTrees.clear();
+    UnloadVegetationLods();
 }
 
 
 
 void DrawTrees(){
-    //sortTrees(camera); //sort trees by distance to camera
+    //alpha tested, so no sorting needed. instances are bucketed per model and LOD, then drawn instanced
+    Vector3 camPos = CameraSystem::Get().Active().position;
     for (const TreeInstance* tree : sortedTrees) {
         Vector3 pos = tree->position;
         pos.y += tree->yOffset;
         pos.x += tree->xOffset;
         pos.z += tree->zOffset;
 
-        Model& treeModel = tree->useAltModel ? ResourceManager::Get().GetModel("palmTree") : ResourceManager::Get().GetModel("palm2");
-
-        DrawModelEx(treeModel, pos, { 0, 1, 0 }, tree->rotationY,
-                    { tree->scale, tree->scale, tree->scale }, WHITE);
-
-
+        QueueVegetation(tree->useAltModel ? VEG_PALM_TREE : VEG_PALM2, pos, tree->rotationY, tree->scale, camPos);
     }
 
-
+    DrawQueuedVegetation(camPos);
 }
 
 void DrawBushes(const std::vector<BushInstance>& bushes) {
+    Vector3 camPos = CameraSystem::Get().Active().position;
     for (const auto& bush : bushes) {
         Vector3 pos = bush.position;
         pos.x += bush.xOffset;
         pos.y += bush.yOffset-10;
         pos.z += bush.zOffset;
-        DrawModel(bush.model, pos, bush.scale, WHITE);
-
+        QueueVegetation(VEG_BUSH, pos, 0.0f, bush.scale, camPos); //bush.model is a copy of "bush"
     }
+
+    DrawQueuedVegetation(camPos);
 }
\ No newline at end of file
@@ -3,9 +3,17 @@
 #include <algorithm>
 #include "rlgl.h"
 #include "char/pathfinding.h"
+#include "render/dungeonChunks.h"
+#include "render/frustum.h"
 #include "render/lighting.h"
+#include "render/renderQueue.h"
+#include "render/terrainChunks.h"
 #include "tools/boat.h"
+#include "world/pvs.h"
+#include "world/rooms.h"
 #include "util/camera_system.h"
+#include "util/collisionWorld.h"
+#include "util/job_pool.h"
 #include "util/resourceManager.h"
 #include "util/sound_manager.h"
 #include "util/ui.h"
@@ -13,9 +21,8 @@
 GameState currentGameState = GameState::Menu;
 
 //global variables, clean these up somehow. 
-Model terrainModel;
+Material terrainMaterial;
 Image heightmap;
-Mesh terrainMesh;
 Vector3 terrainScale = {16000.0f, 200.0f, 16000.0f}; //very large x and z, 
 
 TreeShadowMask gTreeShadowMask;
@@ -91,8 +98,8 @@ void InitLevel(const LevelData& level, Camera& camera) {
     heightmap = LoadImage(level.heightmapPath.c_str());
     ImageFormat(&heightmap, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE);
     
-    terrainMesh = GenMeshHeightmap(heightmap, terrainScale);
-    terrainModel = LoadModelFromMesh(terrainMesh);
+    if (!level.isDungeon) BuildTerrainChunks(heightmap, terrainScale); //chunked LOD terrain instead of one full res mesh
+    if (terrainMaterial.maps == nullptr) terrainMaterial = LoadMaterialDefault(); //kept across levels, maps are set below and in SetTerrainShaderValues
 
 
     dungeonEntrances = level.entrances; //get level entrances from level data
@@ -104,10 +111,10 @@ void InitLevel(const LevelData& level, Camera& camera) {
     //tree shadows after tree generation
     Shader& terrainShader = ResourceManager::Get().GetShader("terrainShader");
     terrainShader.locs[SHADER_LOC_MAP_OCCLUSION] = GetShaderLocation(terrainShader, "textureOcclusion");
-    terrainModel.materials[0].shader = terrainShader;
+    terrainMaterial.shader = terrainShader;
 
     // plug the shadow mask into the material's occlusion map
-    SetMaterialTexture(&terrainModel.materials[0], MATERIAL_MAP_OCCLUSION, gTreeShadowMask.rt.texture);
+    SetMaterialTexture(&terrainMaterial, MATERIAL_MAP_OCCLUSION, gTreeShadowMask.rt.texture);
 
 
     if (!level.isDungeon) InitBoat(player_boat, boatPosition);
@@ -131,6 +138,7 @@ void InitLevel(const LevelData& level, Camera& camera) {
         GenerateDoorways(floorHeight - 20, levelIndex); //calls generate doors from archways
         GenerateLavaSkirtsFromMask(floorHeight);
         GenerateCeilingTiles();//400
+        BuildDungeonChunks(dungeonWidth, dungeonHeight); //merge the static tiles above into per chunk meshes
         GenerateBarrels(floorHeight);
         GenerateLaunchers(floorHeight);
         GenerateSpiderWebs(floorHeight);
@@ -146,6 +154,10 @@ void InitLevel(const LevelData& level, Camera& camera) {
         GenerateSpiderFromImage(dungeonEnemyHeight);
         GenerateGhostsFromImage(dungeonEnemyHeight);
 
+        BuildStaticColliders(); //SoA walls + pillars for the batched bullet pass
+        BuildDungeonPVS(); //tile-to-tile visibility for AI LOS and render culling
+        BuildDungeonRooms(); //rooms split by doorways, portal culling on top of the PVS
+
         if (levelIndex == 4) levels[0].startPosition = {-5653, 200, 6073}; //exit dungeon 3 to dungeon enterance 2 position.
 
         ResourceManager::Get().SetLavaShaderValues();
@@ -250,12 +262,12 @@ void UpdateFade() {
 }
 
 void InitDungeonLights(){
-    InitDynamicLightmap(dungeonWidth * 4); //128 for 32 pixel map. keep same ratio if bigger map. 
+    InitDynamicLightmap(4); // texels per tile, paged so it costs the same on any map size
 
     ResourceManager::Get().SetLightingShaderValues();
 
     BuildStaticLightmapOnce(dungeonLights);
-    BuildDynamicLightmapFromFrameLights(frameLights); // build dynamic light map once for good luck.
+    UploadFrameLights(frameLights); // fill the light clusters once for good luck.
 
 }
 
@@ -271,11 +283,14 @@ void DrawEnemyShadows() {
 
     float enemyStrength = 0.6f;
     SetShaderValue(shadowSh, locStrength, &enemyStrength, SHADER_UNIFORM_FLOAT);
+    const float cullRadius = ModelCullRadius(shadowModel) * 100.0f;
 
     for (Character& enemy : enemies) {
+        if (!RoomsInView(enemy.position, 0.0f)) continue;
         // Ideally, raycast to ground to get exact Y; add tiny epsilon to avoid z-fighting
         Vector3 groundPos = { enemy.position.x, enemy.position.y - 40.1f, enemy.position.z };
         if (enemy.type == CharacterType::Trex) groundPos.y -= 100; //half the frame height? 
+        if (!SphereInView(groundPos, cullRadius)) continue;
         DrawModelEx(shadowModel, groundPos, {0,1,0}, 0.0f, {100,100,100}, BLACK);
     }
 
@@ -469,6 +484,22 @@ void generateRaptors(int amount, Vector3 centerPos, float radius) {
 
 }
 
+// All enemy -> player LOS for this frame in one parallel pass. Nothing moves while it runs,
+// the AI state machines read the result from Character::losToPlayer.
+void UpdateEnemyVisibility() {
+    if (isLoadingLevel || enemies.empty()) return;
+
+    const Vector3 playerPos = player.position;
+    const bool playerInWater = !isDungeon && IsWaterAtXZ(playerPos.x, playerPos.z, 65.0f);
+
+    JobPool::Get().ParallelFor(enemies.size(), 4, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (enemies[i].isDead) continue;
+            enemies[i].ComputePlayerLOS(playerPos, playerInWater);
+        }
+    });
+}
+
 void UpdateEnemies(float deltaTime) {
     if (isLoadingLevel) return;
     for (Character& e : enemies){
@@ -611,7 +642,9 @@ void DrawOverworldProps() {
         Vector3 propPos = {p.x, 300, p.z};
         float propY = GetHeightAtWorldPosition(propPos, heightmap, terrainScale);
         propPos.y = propY;
-        DrawModelEx(ResourceManager::Get().GetModel(modelKey), propPos,
+        Model& propModel = ResourceManager::Get().GetModel(modelKey);
+        if (!SphereInView(propPos, ModelCullRadius(propModel) * p.scale)) continue;
+        RenderQueuePushModel(propModel, propPos,
                     {0,1,0}, p.yawDeg, {p.scale,p.scale,p.scale}, WHITE);
     }
 }
@@ -679,6 +712,7 @@ void UpdateWorldFrame(float dt, Player& player) {
 }
 
 void ClearLevel() {
+    CancelLightRebake(); // the rebake thread reads the dungeon image and light list
     billboardRequests.clear();
     removeAllCharacters();\
     activeBullets.clear();
@@ -688,7 +722,7 @@ void ClearLevel() {
     
     RemoveAllVegetation();
 
-    if (terrainMesh.vertexCount > 0) UnloadMesh(terrainMesh); //unload mesh and heightmap when switching levels. if they exist
+    UnloadTerrainChunks(); //unload terrain and heightmap when switching levels. if they exist
     if (heightmap.data != nullptr) UnloadImage(heightmap); 
     isDungeon = false;
 